@@ -0,0 +1,209 @@
+// Micro-benchmarks of the value types and of interpreter primitives.
+//
+// Each benchmark reports nanoseconds per operation (the best of several
+// runs). The interpreter benchmarks run a script in-process and report
+// the time per loop iteration, loop included.
+//
+// Usage: micro [--runs n] [--json file] [--baseline file] [--filter text]
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "base/evaluator.hpp"
+#include "lpi/lpa_context.hpp"
+#include "report.hpp"
+#include "scanner.hpp"
+
+namespace {
+    using falk::array;
+    using falk::matrix;
+    using falk::scalar;
+    using steady = std::chrono::steady_clock;
+
+    constexpr double MIN_TIME = 0.02;
+
+    // keeps results alive, so that they are not optimized away
+    double sink = 0;
+
+    // seconds taken by f(n)
+    template<typename F>
+    double elapsed(F& f, size_t n) {
+        auto start = steady::now();
+        f(n);
+        return std::chrono::duration<double>(steady::now() - start).count();
+    }
+
+    // nanoseconds per operation of f(n), which performs n operations:
+    // n grows until a run takes MIN_TIME, then the best of runs is taken
+    double measure(std::function<void(size_t)> f, int runs) {
+        size_t n = 1;
+        while (elapsed(f, n) < MIN_TIME && n < (size_t(1) << 40)) {
+            n *= 2;
+        }
+
+        auto best = elapsed(f, n);
+        for (int i = 1; i < runs; i++) {
+            best = std::min(best, elapsed(f, n));
+        }
+        return best * 1e9 / n;
+    }
+
+    struct benchmark {
+        std::string name;
+        std::function<void(size_t)> run;
+    };
+
+    array sequence(size_t n, falk::type type) {
+        array result;
+        result.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            auto value = 1 + i % 7;
+            switch (type) {
+                case falk::type::INT:
+                    result.push_back(scalar(int64_t(value)));
+                    break;
+                case falk::type::COMPLEX:
+                    result.push_back(scalar(std::complex<double>(value, 1)));
+                    break;
+                default:
+                    result.push_back(scalar(value + 0.5));
+            }
+        }
+        return result;
+    }
+
+    matrix square(size_t n) {
+        matrix result;
+        result.reserve(n, n);
+        for (size_t i = 0; i < n; i++) {
+            result.push_back(sequence(n, falk::type::REAL));
+        }
+        return result;
+    }
+
+    template<typename Op>
+    benchmark scalar_case(const std::string& name, scalar a, scalar b, Op op) {
+        return {name, [=](size_t n) {
+            auto result = a;
+            for (size_t i = 0; i < n; i++) {
+                result = op(result, b);
+            }
+            sink += result.real();
+        }};
+    }
+
+    // runs a script in a new interpreter; loops are written with
+    // "N", replaced by the number of iterations
+    benchmark script_case(const std::string& name, const std::string& code) {
+        return {name, [=](size_t n) {
+            auto text = code;
+            for (size_t at; (at = text.find('N')) != std::string::npos;) {
+                text.replace(at, 1, std::to_string(n));
+            }
+            std::istringstream input(text);
+            lpi::lpa_context<falk::scanner, falk::parser, falk::analyser> context;
+            context.console_mode(false);
+            context.switch_input_stream(&input);
+            context.run();
+        }};
+    }
+
+    std::vector<benchmark> benchmarks() {
+        std::vector<benchmark> result;
+        auto add = [](scalar a, scalar b) { return a + b; };
+        auto mul = [](scalar a, scalar b) { return a * b; };
+        for (auto type : {falk::type::INT, falk::type::REAL, falk::type::COMPLEX}) {
+            auto values = sequence(2, type);
+            auto suffix = type == falk::type::INT ? "int"
+                        : type == falk::type::REAL ? "real" : "complex";
+            result.push_back(scalar_case(std::string("scalar_add_") + suffix,
+                                         values[0], values[1], add));
+            result.push_back(scalar_case(std::string("scalar_mul_") + suffix,
+                                         values[0], values[1], mul));
+        }
+
+        // element-wise operations: time per operation, not per element
+        for (size_t size : {16, 1024, 65536}) {
+            auto a = sequence(size, falk::type::REAL);
+            auto b = sequence(size, falk::type::REAL);
+            result.push_back({"array_add_" + std::to_string(size),
+                [=](size_t n) {
+                    for (size_t i = 0; i < n; i++) {
+                        sink += (a + b).size();
+                    }
+                }});
+        }
+
+        for (size_t size : {8, 64, 256}) {
+            auto a = square(size);
+            auto b = square(size);
+            result.push_back({"matrix_add_" + std::to_string(size),
+                [=](size_t n) {
+                    for (size_t i = 0; i < n; i++) {
+                        sink += (a + b).row_count();
+                    }
+                }});
+        }
+
+        for (size_t size : {16, 64, 128}) {
+            auto a = square(size);
+            auto b = square(size);
+            result.push_back({"gemm_" + std::to_string(size),
+                [=](size_t n) {
+                    for (size_t i = 0; i < n; i++) {
+                        sink += (a * b).row_count();
+                    }
+                }});
+        }
+
+        auto m = square(256);
+        result.push_back({"matrix_row_256", [=](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                sink += m.row(i % 256).size();
+            }
+        }});
+        result.push_back({"matrix_column_256", [=](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                sink += m.column(i % 256).size();
+            }
+        }});
+
+        result.push_back({"symbol_lookup", [](size_t n) {
+            falk::symbol_mapper mapper;
+            mapper.declare_variable("x", falk::variable(scalar(1.0)));
+            for (int depth = 0; depth < 4; depth++) {
+                mapper.open_scope();
+                mapper.declare_variable("y" + std::to_string(depth),
+                                        falk::variable(scalar(2.0)));
+            }
+            for (size_t i = 0; i < n; i++) {
+                sink += mapper.retrieve_variable("x").value<scalar>().real();
+            }
+        }});
+
+        result.push_back(script_case("loop_while",
+            "var i = 0\nwhile (i < N): i += 1.\n"));
+        result.push_back(script_case("loop_for",
+            "for (x in 0..N): var y = x.\n"));
+        result.push_back(script_case("create_structure_8",
+            "var i = 0\nwhile (i < N):\n"
+            "auto a = [1, 2, 3, 4, 5, 6, 7, 8]\ni += 1\n.\n"));
+        result.push_back(script_case("function_call",
+            "function f(var x): return x.\n"
+            "var i = 0\nwhile (i < N): i = f(i) + 1.\n"));
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto opts = bench::parse(argc, argv);
+    bench::results values;
+    for (auto& b : benchmarks()) {
+        if (b.name.find(opts.filter) != std::string::npos) {
+            values.emplace_back(b.name + ".ns", measure(b.run, opts.runs));
+        }
+    }
+    return bench::finish(opts, values) + (sink < 0);
+}
@@ -0,0 +1,129 @@
+#ifndef FALK_BENCHMARKS_REPORT_HPP
+#define FALK_BENCHMARKS_REPORT_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reports of the benchmark programs: results are printed as a table and
+// saved as a flat JSON object (name: value), which a later run can read
+// as baseline to print the change of each value.
+namespace bench {
+    using results = std::vector<std::pair<std::string, double>>;
+    using baseline = std::map<std::string, double>;
+
+    struct options {
+        // file to write the results to
+        std::string json;
+        // results of a previous run
+        std::string baseline;
+        // runs only the benchmarks whose name contains it
+        std::string filter;
+        // number of repetitions, for programs that take one
+        int runs = 5;
+        // positional arguments
+        std::vector<std::string> files;
+    };
+
+    // reads --json file, --baseline file, --filter text, --runs n and
+    // positional arguments
+    inline options parse(int argc, char** argv) {
+        options result;
+        for (int i = 1; i < argc; i++) {
+            std::string flag = argv[i];
+            if (flag.compare(0, 2, "--") != 0) {
+                result.files.push_back(flag);
+                continue;
+            }
+            if (i + 1 == argc) {
+                std::cerr << "missing value of " << flag << std::endl;
+                std::exit(2);
+            }
+            std::string value = argv[++i];
+            if (flag == "--json") {
+                result.json = value;
+            } else if (flag == "--baseline") {
+                result.baseline = value;
+            } else if (flag == "--filter") {
+                result.filter = value;
+            } else if (flag == "--runs" && std::atoi(value.c_str()) > 0) {
+                result.runs = std::atoi(value.c_str());
+            } else {
+                std::cerr << "unknown option " << flag << std::endl;
+                std::exit(2);
+            }
+        }
+        return result;
+    }
+
+    inline void write_json(std::ostream& out, const results& values) {
+        out << "{\n";
+        for (size_t i = 0; i < values.size(); i++) {
+            out << "  \"" << values[i].first << "\": "
+                << std::setprecision(6) << values[i].second
+                << (i + 1 < values.size() ? ",\n" : "\n");
+        }
+        out << "}\n";
+    }
+
+    // reads what write_json writes
+    inline baseline read_json(std::istream& in) {
+        std::stringstream content;
+        content << in.rdbuf();
+        auto text = content.str();
+        baseline result;
+        size_t position = 0;
+        while ((position = text.find('"', position)) != std::string::npos) {
+            auto end = text.find('"', position + 1);
+            auto colon = text.find(':', end);
+            if (end == std::string::npos || colon == std::string::npos) {
+                break;
+            }
+            auto name = text.substr(position + 1, end - position - 1);
+            result[name] = std::strtod(text.c_str() + colon + 1, nullptr);
+            position = colon;
+        }
+        return result;
+    }
+
+    // prints the results (and their change from the baseline, if any),
+    // and writes them as JSON if asked to
+    inline int finish(const options& opts, const results& values) {
+        baseline previous;
+        if (!opts.baseline.empty()) {
+            std::ifstream in(opts.baseline);
+            if (!in) {
+                std::cerr << "cannot read " << opts.baseline << std::endl;
+                return 1;
+            }
+            previous = read_json(in);
+        }
+
+        for (auto& entry : values) {
+            std::cout << std::left << std::setw(36) << entry.first
+                      << std::right << std::setw(14) << std::fixed
+                      << std::setprecision(2) << entry.second;
+            auto it = previous.find(entry.first);
+            if (it != previous.end() && it->second != 0) {
+                auto change = 100 * (entry.second - it->second) / it->second;
+                std::cout << std::setw(14) << it->second << std::showpos
+                          << std::setw(10) << change << "%" << std::noshowpos;
+            }
+            std::cout << std::defaultfloat << "\n";
+        }
+
+        if (!opts.json.empty()) {
+            std::ofstream out(opts.json);
+            write_json(out, values);
+        }
+        return 0;
+    }
+}
+
+#endif /* FALK_BENCHMARKS_REPORT_HPP */
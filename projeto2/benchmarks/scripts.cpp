@@ -0,0 +1,178 @@
+// Runs the programs of the script corpus (benchmarks/scripts/*.falk).
+//
+// Each script runs several times, each time in a fresh process (forked
+// from this one) so that runs do not share memory. For each script the
+// report has the median wall time, the peak resident set size and the
+// number and size of the allocations made by the interpreter. A script
+// that reports errors fails its benchmark.
+//
+// Usage: scripts [--runs n] [--json file] [--baseline file]
+//                [--filter text] file.falk...
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include "base/evaluator.hpp"
+#include "lpi/lpa_context.hpp"
+#include "report.hpp"
+#include "scanner.hpp"
+
+namespace {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> allocated{0};
+
+    // what a run sends back to the parent
+    struct sample {
+        double wall_ms;
+        size_t allocations;
+        size_t bytes;
+        long peak_rss_kb;
+    };
+
+    // copies the errors reported in the output of a script to the
+    // standard error, returns whether there were any
+    bool report_errors(const std::string& file, std::FILE* output) {
+        bool found = false;
+        char line[256];
+        std::rewind(output);
+        while (std::fgets(line, sizeof(line), output)) {
+            if (std::strncmp(line, "[Line ", 6) == 0
+                && std::strstr(line, " error: ")) {
+                std::cerr << file << ": " << line;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // runs the script in this process, with its output kept aside to be
+    // checked for errors; returns false if it failed
+    bool execute(const std::string& file, sample& result) {
+        std::ifstream input(file);
+        auto output = std::tmpfile();
+        if (!input || !output) {
+            std::cerr << "cannot open " << file << std::endl;
+            return false;
+        }
+        dup2(fileno(output), STDOUT_FILENO);
+
+        auto before = allocations.load();
+        auto bytes = allocated.load();
+        auto start = std::chrono::steady_clock::now();
+        int status;
+        {
+            lpi::lpa_context<falk::scanner, falk::parser, falk::analyser> context;
+            context.console_mode(false);
+            context.switch_input_stream(&input);
+            status = context.run();
+        }
+        std::chrono::duration<double, std::milli> wall =
+            std::chrono::steady_clock::now() - start;
+        result = {wall.count(), allocations - before, allocated - bytes, 0};
+
+        std::cout.flush();
+        std::fflush(stdout);
+        return !report_errors(file, output) && status == 0;
+    }
+
+    // runs the script in a child process; returns false if it failed
+    bool run(const std::string& file, sample& result) {
+        int channel[2];
+        if (pipe(channel) != 0) {
+            return false;
+        }
+
+        auto pid = fork();
+        if (pid == 0) {
+            close(channel[0]);
+            sample s;
+            if (!execute(file, s)) {
+                _exit(1);
+            }
+            auto written = write(channel[1], &s, sizeof(s));
+            _exit(written == sizeof(s) ? 0 : 1);
+        }
+        close(channel[1]);
+
+        auto received = pid > 0 && read(channel[0], &result, sizeof(result))
+                                   == sizeof(result);
+        close(channel[0]);
+
+        int status = 0;
+        struct rusage usage;
+        if (pid < 0 || wait4(pid, &status, 0, &usage) != pid) {
+            return false;
+        }
+        result.peak_rss_kb = usage.ru_maxrss;
+        return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::string name_of(const std::string& file) {
+        auto start = file.find_last_of('/') + 1;
+        auto end = file.rfind(".falk");
+        return file.substr(start, end == std::string::npos || end < start
+                                  ? std::string::npos : end - start);
+    }
+}
+
+void* operator new(size_t size) {
+    ++allocations;
+    allocated += size;
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    auto opts = bench::parse(argc, argv);
+    bench::results values;
+    bool failed = false;
+    for (auto& file : opts.files) {
+        auto name = name_of(file);
+        if (name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+
+        std::vector<sample> samples(opts.runs);
+        auto ok = std::all_of(samples.begin(), samples.end(),
+                              [&](sample& s) { return run(file, s); });
+        if (!ok) {
+            std::cerr << "failed to run " << file << std::endl;
+            failed = true;
+            continue;
+        }
+
+        std::sort(samples.begin(), samples.end(),
+                  [](const sample& a, const sample& b) {
+                      return a.wall_ms < b.wall_ms;
+                  });
+        auto peak = std::max_element(samples.begin(), samples.end(),
+                                     [](const sample& a, const sample& b) {
+                                         return a.peak_rss_kb < b.peak_rss_kb;
+                                     });
+        auto& median = samples[samples.size() / 2];
+        values.emplace_back(name + ".wall_ms", median.wall_ms);
+        values.emplace_back(name + ".peak_rss_kb", peak->peak_rss_kb);
+        values.emplace_back(name + ".allocations", median.allocations);
+        values.emplace_back(name + ".allocated_kb", median.bytes / 1024.0);
+    }
+    return bench::finish(opts, values) + failed;
+}
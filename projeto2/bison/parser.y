@@ -22,6 +22,20 @@
     #include "parser.hpp"
     #include "location.hh"
 
+    // The default location of a rule, which is also given to the nodes
+    // created by its action.
+    #define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+        do {                                                               \
+            if (N) {                                                       \
+                (Current).begin = YYRHSLOC(Rhs, 1).begin;                  \
+                (Current).end = YYRHSLOC(Rhs, N).end;                      \
+            } else {                                                       \
+                (Current).begin = (Current).end = YYRHSLOC(Rhs, 0).end;    \
+            }                                                              \
+            ast::cursor().line = (Current).begin.line;                     \
+            ast::cursor().column = (Current).begin.column;                 \
+        } while (false)
+
     static falk::parser::symbol_type yylex(falk::scanner& scanner) {
         return scanner.next_token();
     }
@@ -42,6 +56,7 @@
 %token VAR       "var keyword";
 %token ARRAY     "array keyword";
 %token MATRIX    "matrix keyword";
+%token DICT      "dict keyword";
 %token TYPEOF    "typeof operator";
 %token SEMICOLON "semicolon";
 %token NL        "new line";
@@ -52,6 +67,7 @@
 %token WHILE     "while keyword";
 %token AUTO      "auto keyword";
 %token UNDEF     "undef keyword";
+%token WHOS      ":whos command";
 %token IN        "in keyword";
 %token RET       "return keyword";
 %token FUN       "function keyword";
@@ -61,6 +77,7 @@
 %token CPAR      ")";
 %token COLON     ":";
 %token DOT       ".";
+%token RANGE     "..";
 %token OBRACKET  "[";
 %token CBRACKET  "]";
 %token EOF 0     "end of file";
@@ -69,6 +86,7 @@
 %token<std::string> ID      "variable identifier";
 %token<std::string> STRING  "string";
 %token<falk::type> TYPE       "type identifier";
+%token<falk::integer> INT     "integer value";
 %token<falk::real> REAL       "real value";
 %token<falk::complex> COMPLEX "complex value";
 %token<falk::boolean> BOOL    "boolean value";
@@ -88,6 +106,7 @@
 // Non-terminals
 %type<falk::list>  block block_body;
 %type<falk::list>  conditional loop;
+%type<falk::list> range;
 %type<falk::list> arr_size mat_size;
 %type<falk::rvalue> command normal_command special_command;
 %type<falk::rvalue> scoped_block;
@@ -103,14 +122,17 @@
 %type<falk::parameters> param_list;
 %type<falk::parameter> param;
 %type<falk::real> literal_arr_size;
+%type<falk::real> literal_size;
 %type<std::pair<falk::real, falk::real>> literal_mat_size;
 
 // Operators precedence.
 // The latest it is listed, the highest the precedence.
 // Possible types: left, right, nonassoc
+%nonassoc RANGE
+%nonassoc COLON
 %left AND OR
 %nonassoc NOT
-%left COMPARISON
+%left COMPARISON IN
 %left PLUS MINUS
 %left TIMES DIVIDE MOD
 %left POWER
@@ -132,7 +154,7 @@ entry:
       program command      { analyser.process($2); }
     | program scoped_block { analyser.process($2); };
 
-new_line: NL { context.count_new_line(); };
+new_line: NL;
 
 eoc:
       SEMICOLON
@@ -187,6 +209,7 @@ block_body:
 normal_command:
     return        { $$ = $1; }
     | undef       { $$ = $1; }
+    | WHOS        { $$ = {falk::whos()}; }
     | single_calc { $$ = {falk::print(), $1}; }
     | assignment  { $$ = $1.extract(); }
     | decl_var    { $$ = $1.extract(); }
@@ -237,6 +260,14 @@ decl_var:
         auto decl = falk::declare_variable{$2, false, structural::type::MATRIX};
         $$ = falk::declaration(decl, $4);
     }
+    | DICT ID {
+        auto decl = falk::declare_variable{$2, false, structural::type::DICT};
+        $$ = falk::declaration(decl);
+    }
+    | DICT ID ASSIGN rvalue {
+        auto decl = falk::declare_variable{$2, false, structural::type::DICT};
+        $$ = falk::declaration(decl, $4);
+    }
     | AUTO ID ASSIGN rvalue {
         auto decl = falk::declare_variable{$2, true};
         $$ = falk::declaration(decl, $4);
@@ -296,6 +327,9 @@ param:
     | MATRIX literal_mat_size ID {
         $$ = {falk::var_id{$3, $2}, falk::structural::type::MATRIX};
     }
+    | DICT ID {
+        $$ = {{$2}, falk::structural::type::DICT};
+    }
     ;
 
 assignment:
@@ -334,6 +368,11 @@ loop:
         $$ += $5.extract();
         $$ += $7;
     }
+    | FOR OPAR ID IN range CPAR block {
+        $$ = falk::for_it{$3};
+        $$ += $5;
+        $$ += $7;
+    }
     ;
 
 return: RET rvalue { $$ = {falk::ret(), $2}; };
@@ -342,9 +381,26 @@ undef: UNDEF ID { $$ = {falk::undef{$2}}; };
 
 rvalue: expr { $$ = $1; };
 
-literal_arr_size: OBRACKET REAL CBRACKET { $$ = $2; };
+range:
+    expr RANGE expr {
+        $$ = falk::make_range();
+        $$ += $1;
+        $$ += $3;
+        $$ += falk::rvalue{falk::scalar(falk::integer{1})};
+    }
+    | expr RANGE expr COLON expr %prec RANGE {
+        $$ = falk::make_range();
+        $$ += $1;
+        $$ += $3;
+        $$ += $5;
+    };
+
+literal_arr_size: OBRACKET literal_size CBRACKET { $$ = $2; };
+
+literal_mat_size:
+    OBRACKET literal_size COMMA literal_size CBRACKET { $$ = {$2, $4}; };
 
-literal_mat_size: OBRACKET REAL COMMA REAL CBRACKET { $$ = {$2, $4}; };
+literal_size: INT { $$ = $1; } | REAL { $$ = $1; };
 
 arr_size:
     OBRACKET rvalue CBRACKET {
@@ -399,7 +455,10 @@ container_body:
     };
 
 expr:
-    REAL {
+    INT {
+        $$ = falk::scalar($1);
+    }
+    | REAL {
         $$ = falk::scalar($1);
     }
     | COMPLEX {
@@ -410,7 +469,10 @@ expr:
     }
     | container {
         $$ = $1.extract();
-    };
+    }
+    | range {
+        $$ = $1.extract();
+    }
     | lvalue {
         $$ = $1;
     }
@@ -420,6 +482,12 @@ expr:
     | expr COMPARISON expr {
         $$ = make_comparison($2, $1, $3);
     }
+    | expr IN expr {
+        falk::list args = falk::block();
+        args += $1;
+        args += $3;
+        $$ = {falk::fun_id{"in", 2}, args};
+    }
     | expr PLUS expr {
         $$ = $1 + $3;
     }
@@ -2,6 +2,7 @@
 #ifndef FALK_AST_NODE_HPP
 #define FALK_AST_NODE_HPP
 
+#include <iterator>
 #include <memory>
 #include <type_traits>
 #include "aut/value_holder.hpp"
@@ -35,8 +36,21 @@ namespace ast {
     }; 
 
 
+    // Place of a node in the source code (1-based, 0 if unknown).
+    struct position {
+        unsigned line = 0;
+        unsigned column = 0;
+    };
+
+    // Position given to the nodes being created. The parser moves it to
+    // the construct being reduced before running its action.
+    inline position& cursor() {
+        static position current;
+        return current;
+    }
+
     // This class defines an interface to construct the hole abstract syntax
-    // tree. There are 4 methods provided:
+    // tree. There are 5 methods provided:
     // visit(Analyser&) - pass all information about the node to the
     // analyser.
     // add_subnode(std::shared_ptr<node<Analyser>>) - allows the adition of
@@ -44,6 +58,8 @@ namespace ast {
     // empty() - used to detect empty nodes, usually skipped in semantic
     // analysis.
     // size() - returns the number of subnodes.
+    // subnode(size_t) - returns the i-th subnode, or nullptr if there is none.
+    // Each node also keeps the position where it was created (where()).
     template<typename Analyser>
     class node {
      public:
@@ -51,6 +67,12 @@ namespace ast {
         virtual void add_subnode(std::shared_ptr<node<Analyser>>) = 0;
         virtual bool empty() { return false; }
         virtual size_t size() const = 0;
+        virtual std::shared_ptr<node<Analyser>> subnode(size_t) const {
+            return nullptr;
+        }
+        const position& where() const { return place; }
+     private:
+        position place = cursor();
     };
 
     // This class allows to create a node holding any kind of value.
@@ -61,6 +83,8 @@ namespace ast {
     // a method called arity(). If a value has this method,
     // it can have children. If arity() returns a positive value, it's children
     // will be holded in an array, otherwise, a list.
+    // An Analyser::probe<T>, built from the position of the node, is kept
+    // alive while the value is analysed.
     template<typename Analyser, typename T, bool = has_arity<T>::value>
     class model;
 
@@ -71,10 +95,12 @@ namespace ast {
      public:
         model(const T& d) : data{d} { }
         void visit(Analyser& analyser) override {
+            typename Analyser::template probe<T> measure{this->where()};
             analyser.analyse(data);
         }
         void add_subnode(node_ptr node) override { }
         size_t size() const override { return 0; }
+        T& value() { return data; }
      private:
         T data;
     };
@@ -87,6 +113,7 @@ namespace ast {
      public:
         model(const T& d) : data{d} { }
         void visit(Analyser& analyser) override {
+            typename Analyser::template probe<T> measure{this->where()};
             analyser.analyse(data, subnodes.container);
         }
         void add_subnode(node_ptr node) override {
@@ -94,6 +121,13 @@ namespace ast {
         }
 
         size_t size() const override { return subnodes.container.size(); }
+        node_ptr subnode(size_t index) const override {
+            if (index >= size()) {
+                return nullptr;
+            }
+            return *std::next(subnodes.container.begin(), index);
+        }
+        T& value() { return data; }
      private:
         T data;
         holder subnodes;
@@ -109,6 +143,15 @@ namespace ast {
         bool empty() override { return true; }
         size_t size() const override { return 0; }
     };
+
+    // Retrieves the value held by a node if it was built from a T,
+    // nullptr otherwise. Allows passes over the tree (e.g. the optimizer)
+    // to recognize patterns without visiting it.
+    template<typename T, typename Analyser>
+    T* inspect(const std::shared_ptr<node<Analyser>>& target) {
+        auto holder = dynamic_cast<model<Analyser, T>*>(target.get());
+        return holder ? &holder->value() : nullptr;
+    }
 }
 
 #endif /* FALK_AST_NODE_HPP */
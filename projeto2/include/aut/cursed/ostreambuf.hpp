@@ -5,9 +5,22 @@
 #include <streambuf>
 
 namespace cursed {
+    // Writes to the screen in blocks: characters are collected in a
+    // buffer, written at once when it is full or flushed, and the screen
+    // is refreshed only on flushes.
     class ostreambuf : public std::streambuf {
     public:
+        ostreambuf();
+
         int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char*, std::streamsize) override;
+        int sync() override;
+    private:
+        static constexpr size_t BUFFER_SIZE = 4096;
+        char buffer[BUFFER_SIZE];
+
+        // writes the buffered characters, without refreshing
+        void drain();
     };
 }
 
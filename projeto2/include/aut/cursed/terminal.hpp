@@ -27,6 +27,9 @@ namespace cursed {
         Buffer::const_iterator buffer_it;        
         std::string current_input;
         std::string unsaved_input;
+        // pasted text after the last complete line, which starts the
+        // next line
+        std::string pending_input;
         unsigned o_cursor_x = 0;
         unsigned cursor_x = 0;
         unsigned cursor_y = 0;
@@ -41,6 +44,8 @@ namespace cursed {
         void end_pressed();
         void page_up_pressed();
         void page_down_pressed();
+        // takes pasted text at once, returns true if it completes lines
+        bool paste_pressed();
         void save_character(int);
     };
 }
@@ -2,6 +2,7 @@
 #define ASZDRICK_UTILITIES_HPP
 
 #include <array>
+#include <deque>
 #include <list>
 #include <type_traits>
 
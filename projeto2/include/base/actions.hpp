@@ -2,11 +2,15 @@
 #ifndef FALK_ACTIONS_HPP
 #define FALK_ACTIONS_HPP
 
+#include <memory>
+
 #include "types.hpp"
 #include "types/variable.hpp"
 
 namespace falk {
-    
+    struct kernel;
+    struct proof;
+
     struct block {
         static constexpr int arity() { return -1; }
     };
@@ -26,12 +30,20 @@ namespace falk {
 
     struct loop {
         static constexpr size_t arity() { return 2; }
+
+        // native kernel, if the loop matches an idiom (see optimizer.hpp)
+        std::shared_ptr<kernel> plan;
+        // accesses indexed by the loop counter that may skip bounds checks
+        std::shared_ptr<proof> bounds;
+        bool analysed = false;
     };
 
     struct for_it {
         static constexpr size_t arity() { return 2; }
 
         std::string var_name;
+        std::shared_ptr<kernel> plan;
+        bool analysed = false;
     };
 
     struct ret {
@@ -42,6 +54,8 @@ namespace falk {
         std::string id;
     };
 
+    struct whos { };
+
     struct valueof {
         static constexpr size_t arity() { return 1; }
     };
@@ -55,7 +69,12 @@ namespace falk {
 
         std::string id;
         std::pair<int64_t, int64_t> index = {-1, -1};
+        // first index as given, used as key when indexing a dict
+        scalar key;
+        bool keyed = false;
         bool fail = false;
+        // set by the enclosing loop when each index is known to be in range
+        std::pair<bool, bool> proven = {false, false};
     };
 
     struct fun_id {
@@ -69,6 +88,10 @@ namespace falk {
         static constexpr int arity() { return -1; }
     };
 
+    struct make_range {
+        static constexpr size_t arity() { return 3; }
+    };
+
     struct parameter {
         var_id vid;
         structural::type s_type;
@@ -0,0 +1,49 @@
+#ifndef FALK_AUDIT_HPP
+#define FALK_AUDIT_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace falk {
+    class variable;
+
+    // Audit of implicit conversions and copies (falk --audit). Each one
+    // is recorded with the line being evaluated and the bytes it moved,
+    // and the most expensive are reported at exit.
+    namespace audit {
+        extern bool enabled;
+
+        enum class conversion {
+            // array::coerce_to raising the type of the elements
+            COERCION,
+            // matrix::prepare raising the type of the existing rows
+            RETYPING,
+            // scalar::to_array, to operate with an array
+            BROADCAST,
+            // array::to_matrix, to operate with a matrix
+            PROMOTION,
+            // structure pushed whole by valueof
+            VALUE_COPY,
+            // value stored as the last result (res)
+            RESULT_COPY,
+            COUNT,
+        };
+
+        // starts recording (and keeping the line being evaluated)
+        void start();
+        void note(conversion, size_t bytes);
+        // prints the conversions which moved more bytes
+        void report(std::ostream&);
+
+        inline void record(conversion kind, size_t bytes) {
+            if (enabled) {
+                note(kind, bytes);
+            }
+        }
+
+        // bytes of the elements of a value
+        size_t bytes(const variable&);
+    }
+}
+
+#endif /* FALK_AUDIT_HPP */
@@ -0,0 +1,33 @@
+#ifndef FALK_BUILTINS_HPP
+#define FALK_BUILTINS_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast/node.hpp"
+
+namespace falk {
+    class evaluator;
+
+    // Functions implemented natively. They receive the argument nodes
+    // unevaluated, so that a builtin can change a variable in place
+    // (see evaluator::reference), and must push exactly one result.
+    // User functions with the same name take precedence.
+    namespace builtins {
+        using node_ptr = std::shared_ptr<ast::node<evaluator>>;
+        using arguments = std::vector<node_ptr>;
+        using callback = void (*)(evaluator&, arguments&);
+
+        struct builtin {
+            size_t min_arity;
+            size_t max_arity;
+            callback call;
+        };
+
+        // Returns the builtin with the given name, or nullptr.
+        const builtin* find(const std::string&);
+    }
+}
+
+#endif /* FALK_BUILTINS_HPP */
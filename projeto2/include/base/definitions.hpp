@@ -15,6 +15,7 @@ namespace falk {
     
     // Semantic types (objects) definitions.
     using real = analyser::real;
+    using integer = analyser::integer;
     using complex = analyser::complex;
     using boolean = analyser::boolean;
     using array = analyser::array;
@@ -43,6 +43,10 @@ enum class Error {
     FOR_ALREADY_DECLARED,
     RETURN_OUT_OF_FUNCTION,
     NONSCALAR_SIZE,
+    NONSCALAR_RANGE,
+    INVALID_ARGUMENT,
+    INVALID_OPERAND,
+    KEY_NOT_FOUND,
 };
 
 namespace std {
@@ -59,12 +63,14 @@ namespace err {
         {falk::type::REAL, "real"},
         {falk::type::COMPLEX, "complex"},
         {falk::type::BOOL, "boolean"},
+        {falk::type::INT, "integer"},
     };
 
     const std::unordered_map<falk::struct_t, std::string> struct_type_table = {
         {falk::struct_t::SCALAR, "scalar"},
         {falk::struct_t::ARRAY, "array"},
         {falk::struct_t::MATRIX, "matrix"},
+        {falk::struct_t::DICT, "dict"},
     };
 
     void set_context(lpi::context&);
@@ -86,6 +92,8 @@ namespace err {
     template<Error>
     inline void semantic(const std::string&, const std::string&, size_t, size_t, size_t, size_t);
     template<Error>
+    inline void semantic(const std::string&, const std::string&);
+    template<Error>
     inline void semantic(const std::string&);
     template<Error>
     inline void semantic();
@@ -308,6 +316,30 @@ namespace err {
     inline void semantic<Error::NONSCALAR_SIZE>() {
         echo(error_prefix("semantic") + "the size must be a scalar");
     }
+
+    template<>
+    inline void semantic<Error::INVALID_ARGUMENT>(const std::string& fn,
+                                                  const std::string& extra) {
+        echo(error_prefix("semantic") + "invalid argument for function " +
+            fn + ": " + extra);
+    }
+
+    template<>
+    inline void semantic<Error::INVALID_OPERAND>(const std::string& op,
+                                                 const std::string& extra) {
+        echo(error_prefix("semantic") + "invalid operand for operator " +
+            op + ": " + extra);
+    }
+
+    template<>
+    inline void semantic<Error::KEY_NOT_FOUND>(const std::string& key) {
+        echo(error_prefix("semantic") + "key " + key + " not found");
+    }
+
+    template<>
+    inline void semantic<Error::NONSCALAR_RANGE>() {
+        echo(error_prefix("semantic") + "range bounds and step must be scalars");
+    }
 }
 
 #endif /* ERRORS_HPP */
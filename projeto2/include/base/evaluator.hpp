@@ -2,8 +2,11 @@
 #ifndef FALK_EV_AST_EVALUATOR_REAL_HPP
 #define FALK_EV_AST_EVALUATOR_REAL_HPP
 
+#include <cerrno>
 #include <complex>
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
 #include <stack>
 
 #include "actions.hpp"
@@ -12,11 +15,18 @@
 #include "ast/lvalue.hpp"
 #include "ast/rvalue.hpp"
 #include "aut/utilities.hpp"
+#include "builtins.hpp"
 #include "operators.hpp"
+#include "optimizer.hpp"
+#include "profiler.hpp"
+#include "statistics.hpp"
+#include "tracer.hpp"
 #include "symbol_mapper.hpp"
 #include "types.hpp"
 #include "types/array.hpp"
+#include "types/dict.hpp"
 #include "types/matrix.hpp"
+#include "types/range.hpp"
 
 namespace falk {
     // Responsible for all semantic actions in 'interpreted mode'
@@ -28,11 +38,13 @@ namespace falk {
      public:
         // Aliases to define semantical types (objects).
         using real = double;
+        using integer = int64_t;
         using complex = std::complex<double>;
         using boolean = bool;
         using array = array;
         using matrix = matrix;
         using scalar = scalar;
+        using dict = dict;
 
         // Alias to define abstractions for AST construction.
         using declaration = ast::declaration<evaluator>;
@@ -40,11 +52,25 @@ namespace falk {
         using list = ast::list<evaluator>;
         using lvalue = ast::lvalue<evaluator>;
         using rvalue = ast::rvalue<evaluator>;
+        // measures the evaluation of nodes (see statistics.hpp and
+        // profiler.hpp)
+        template<typename T>
+        class probe {
+         public:
+            explicit probe(const ast::position& where) : mark{where.line} { }
+         private:
+            profiler::marker mark;
+            stats::probe<T> measure;
+        };
 
         // enable/disable console mode (see prompt() method)
         void console_mode(bool);
         // instantiates a real token
         real make_real(const std::string&);
+        // checks if an integer literal fits in an integer token
+        bool is_integer(const std::string&);
+        // instantiates an integer token
+        integer make_integer(const std::string&);
         // instantiates a complex token
         complex make_complex(const std::string&);
         // instantiates a boolean token
@@ -59,20 +85,26 @@ namespace falk {
         void analyse(const conditional&, node_array<3>&);
         // creates a structure to store data to initialize arrays and matrices
         void analyse(const create_structure&, std::list<node_ptr>&);
+        // creates an array with the elements of a range
+        void analyse(const make_range&, node_array<3>&);
         // declares a variable
         void analyse(const declare_variable&, node_array<1>&);
         // declares a function
         void analyse(const declare_function&, node_array<1>&);
         // executes 'for' loops
-        void analyse(const for_it&, node_array<2>&);
+        void analyse(for_it&, node_array<2>&);
         // executes 'while' loops
-        void analyse(const loop&, node_array<2>&);
+        void analyse(loop&, node_array<2>&);
         // place a value as return
         void analyse(const ret&, node_array<1>&);
         // remove definition of a given function
         void analyse(const undef&);
+        // lists the variables and their memory (:whos)
+        void analyse(const whos&);
         // retrieves a given id as function
         void analyse(fun_id&, node_array<1>&);
+        // calls a native function
+        void call(const builtins::builtin&, const fun_id&, node_array<1>&);
         // retrieves a given id as variable
         void analyse(var_id&, node_array<2>&);
         // prints a value
@@ -100,6 +132,18 @@ namespace falk {
         void handle_operation(const Operation&, structural::type, Stack&);
         // Auxiliar method for variable declarations
         void get_value(symbol_mapper&, const declare_variable&);
+        // Runs a MAP kernel, returns false if it does not apply to the
+        // current values (the loop must then be interpreted)
+        bool execute(const kernel&);
+        // Marks the accesses of a proof as unchecked if their indexes
+        // cannot leave the bounds during the loop about to start
+        void verify(const proof&);
+        // Runs a REDUCTION kernel over the elements (rows) of a variable
+        bool execute(const kernel&, variable&);
+        // Runs a REDUCTION kernel over the elements of a range
+        bool execute(const kernel&, const range&);
+        // Evaluates the start, stop and step of a range
+        range range_of(node_array<3>&);
         // Process a command, received as a node
         void process(node_ptr);
         // prompts "falk>"
@@ -110,19 +154,46 @@ namespace falk {
         void push(const array&);
         // pushes a matrix to matrix_stack
         void push(const matrix&);
+        // pushes a dict to dict_stack
+        void push(const dict&);
+        // pops a value of the given type, discarding it
+        void discard(structural::type);
         // pushes a var_id to id_stack
         void push(const var_id&);
+        // pushes the value of a variable to the stack of its type
+        void push(const variable&);
+        // evaluates the argument of a builtin
+        variable evaluate(const node_ptr&);
+        // retrieves the variable named by the argument of a builtin, if
+        // it is a plain variable (without indexes)
+        variable* reference(const node_ptr&);
+        // retrieves the name of the user function named by the argument
+        // of a builtin, or an empty string if it names none
+        std::string function_of(const node_ptr&);
+        // calls a user function with the given arguments
+        variable invoke(const std::string&, const std::vector<variable>&);
+        // the symbols of every scope
+        const symbol_mapper& symbols() const;
      private:
         symbol_mapper mapper;
         std::deque<scalar> scalar_stack;
         std::deque<array> array_stack;
         std::deque<matrix> matrix_stack;
+        std::deque<dict> dict_stack;
         std::deque<var_id> id_stack;
         std::deque<structural::type> types_stack;
         bool console = true;
         bool return_called = false;
         size_t function_counter = 0;
         // size_t return_counter = 0;
+
+        // binds the arguments on the stacks to the parameters of a
+        // function, then runs it, leaving its result on the stacks
+        void enter(function&, const std::string&);
+        // pops the value on top of the stacks
+        variable pop();
+        // the identifier of a node which is a plain variable access
+        var_id* identifier(const node_ptr&);
     };
 }
 
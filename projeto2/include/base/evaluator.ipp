@@ -7,6 +7,13 @@ void falk::evaluator::analyse(op::callback<Type, OP, 2> op,
     }
     auto t1 = aut::pop(types_stack);
     auto t2 = aut::pop(types_stack);
+    if (t1 == structural::type::DICT || t2 == structural::type::DICT) {
+        err::semantic<Error::ILLEGAL_OPERATION>("dictionary arithmetic");
+        discard(t1);
+        discard(t2);
+        push(scalar::invalid());
+        return;
+    }
 
     switch (t2) {
         case structural::type::SCALAR:
@@ -63,12 +70,18 @@ void falk::evaluator::analyse(op::callback<Type, OP, 1> op,
         case structural::type::MATRIX:
             push(op(aut::pop(matrix_stack)));
             break;
+        case structural::type::DICT:
+            err::semantic<Error::ILLEGAL_OPERATION>("dictionary arithmetic");
+            discard(t1);
+            push(scalar::invalid());
+            break;
     }
 }
 
 template<falk::op::assignment OP>
 void falk::evaluator::analyse(op::callback<op::assignment, OP, 2> op,
                                   node_array<2>& nodes) {
+    // elements are updated on a copy, so that integers stay dense
     auto apply = [&](auto& op, auto& vid, auto& rhs) {
         variable& var = mapper.retrieve_variable(vid.id);
         switch (var.stored_type()) {
@@ -78,8 +91,13 @@ void falk::evaluator::analyse(op::callback<op::assignment, OP, 2> op,
             }
             case structural::type::ARRAY: {
                 auto& value = var.value<array>();
-                if (vid.index.first > -1) {
-                    op(value[vid.index.first], rhs);
+                if (vid.index.first >= static_cast<int64_t>(value.size())) {
+                    err::semantic<Error::INDEX_OUT_OF_BOUNDS>(value.size(),
+                                                              vid.index.first);
+                } else if (vid.index.first > -1) {
+                    auto element = value.unchecked(vid.index.first);
+                    op(element, rhs);
+                    value.set(vid.index.first, element);
                 } else {
                     op(var, rhs);
                 }
@@ -87,7 +105,18 @@ void falk::evaluator::analyse(op::callback<op::assignment, OP, 2> op,
             }
             case structural::type::MATRIX: {
                 auto& value = var.value<matrix>();
-                if (vid.index.first > -1 && vid.index.second > -1) {
+                auto row = vid.index.first;
+                auto column = vid.index.second;
+                bool inside = row < static_cast<int64_t>(value.row_count())
+                    && column < static_cast<int64_t>(value.column_count());
+                if ((vid.proven.first && vid.proven.second)
+                    || (row > -1 && column > -1 && inside)) {
+                    const matrix& cells = value;
+                    auto element = cells.unchecked(row, column);
+                    op(element, rhs);
+                    value.set(row, column, element);
+                } else if (vid.index.first > -1 && vid.index.second > -1) {
+                    // reports the index out of bounds
                     op(value.at(vid.index.first, vid.index.second), rhs);
                 } else if (vid.index.first > -1) {
                     auto data = value.row(vid.index.first);
@@ -102,6 +131,23 @@ void falk::evaluator::analyse(op::callback<op::assignment, OP, 2> op,
                 }
                 break;
             }
+            case structural::type::DICT: {
+                auto& value = var.value<dict>();
+                if (!vid.keyed) {
+                    op(var, rhs);
+                } else if (OP == op::assignment::DIRECT) {
+                    if (!rhs.error()) {
+                        value.insert(vid.key, variable(rhs));
+                    }
+                } else if (auto entry = value.find(vid.key)) {
+                    op(*entry, rhs);
+                } else {
+                    std::ostringstream key;
+                    key << vid.key;
+                    err::semantic<Error::KEY_NOT_FOUND>(key.str());
+                }
+                break;
+            }
         }
     };
 
@@ -126,6 +172,23 @@ void falk::evaluator::analyse(op::callback<op::assignment, OP, 2> op,
             apply(op, vid, rhs);
             break;
         }
+        case structural::type::DICT: {
+            // dicts are only assigned whole, and hold no dicts
+            auto rhs = aut::pop(dict_stack);
+            auto& var = mapper.retrieve_variable(vid.id);
+            if (OP == op::assignment::DIRECT && !vid.keyed
+                && var.stored_type() == structural::type::DICT) {
+                if (!rhs.error()) {
+                    var = variable(rhs);
+                }
+            } else {
+                err::semantic<Error::ILLEGAL_ASSIGNMENT>(
+                    vid.keyed ? structural::type::SCALAR : var.stored_type(),
+                    structural::type::DICT
+                );
+            }
+            break;
+        }
     }
 }
 
@@ -153,15 +216,65 @@ inline void falk::evaluator::push(const matrix& data) {
     types_stack.push_back(structural::type::MATRIX);
 }
 
+inline void falk::evaluator::push(const dict& data) {
+    dict_stack.push_back(data);
+    types_stack.push_back(structural::type::DICT);
+}
+
+inline void falk::evaluator::discard(structural::type type) {
+    switch (type) {
+        case structural::type::SCALAR:
+            aut::pop(scalar_stack);
+            break;
+        case structural::type::ARRAY:
+            aut::pop(array_stack);
+            break;
+        case structural::type::MATRIX:
+            aut::pop(matrix_stack);
+            break;
+        case structural::type::DICT:
+            aut::pop(dict_stack);
+            break;
+    }
+}
+
 inline void falk::evaluator::push(const var_id& data) {
     id_stack.push_back(data);
 }
 
+inline void falk::evaluator::push(const variable& data) {
+    switch (data.stored_type()) {
+        case structural::type::SCALAR:
+            push(data.value<scalar>());
+            break;
+        case structural::type::ARRAY:
+            push(data.value<array>());
+            break;
+        case structural::type::MATRIX:
+            push(data.value<matrix>());
+            break;
+        case structural::type::DICT:
+            push(data.value<dict>());
+            break;
+    }
+}
+
 inline falk::evaluator::real
 falk::evaluator::make_real(const std::string& text) {
     return std::stod(text);
 }
 
+inline bool falk::evaluator::is_integer(const std::string& text) {
+    errno = 0;
+    std::strtoll(text.c_str(), nullptr, 10);
+    return errno != ERANGE;
+}
+
+inline falk::evaluator::integer
+falk::evaluator::make_integer(const std::string& text) {
+    return std::strtoll(text.c_str(), nullptr, 10);
+}
+
 inline falk::evaluator::complex
 falk::evaluator::make_complex(const std::string& text) {
     auto clean_text = text.substr(0, text.size() - 2);
@@ -340,6 +340,69 @@ namespace falk {
                 return lhs |= rhs;
         }
     }
+
+    // Calls f with the callback that corresponds to an arithmetic operation
+    // known only at runtime.
+    template<typename F>
+    void with_callback(op::arithmetic operation, F&& f) {
+        using A = op::arithmetic;
+        switch (operation) {
+            case A::ADD:
+                f(op::callback<A, A::ADD, 2>());
+                break;
+            case A::SUB:
+                f(op::callback<A, A::SUB, 2>());
+                break;
+            case A::DIV:
+                f(op::callback<A, A::DIV, 2>());
+                break;
+            case A::MULT:
+                f(op::callback<A, A::MULT, 2>());
+                break;
+            case A::POW:
+                f(op::callback<A, A::POW, 2>());
+                break;
+            case A::MOD:
+                f(op::callback<A, A::MOD, 2>());
+                break;
+        }
+    }
+
+    // Calls f with the callback that corresponds to an assignment operation
+    // known only at runtime.
+    template<typename F>
+    void with_callback(op::assignment operation, F&& f) {
+        using A = op::assignment;
+        switch (operation) {
+            case A::DIRECT:
+                f(op::callback<A, A::DIRECT, 2>());
+                break;
+            case A::ADD:
+                f(op::callback<A, A::ADD, 2>());
+                break;
+            case A::SUB:
+                f(op::callback<A, A::SUB, 2>());
+                break;
+            case A::DIV:
+                f(op::callback<A, A::DIV, 2>());
+                break;
+            case A::MULT:
+                f(op::callback<A, A::MULT, 2>());
+                break;
+            case A::POW:
+                f(op::callback<A, A::POW, 2>());
+                break;
+            case A::MOD:
+                f(op::callback<A, A::MOD, 2>());
+                break;
+            case A::AND:
+                f(op::callback<A, A::AND, 2>());
+                break;
+            case A::OR:
+                f(op::callback<A, A::OR, 2>());
+                break;
+        }
+    }
 }
 
 #endif /* FALK_OPERATORS_HPP */
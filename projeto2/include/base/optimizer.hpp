@@ -0,0 +1,95 @@
+#ifndef FALK_OPTIMIZER_HPP
+#define FALK_OPTIMIZER_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "actions.hpp"
+#include "ast/node.hpp"
+#include "operators.hpp"
+#include "types/scalar.hpp"
+
+namespace falk {
+    class evaluator;
+
+    // Description of a loop whose body matches a known idiom and can be
+    // executed natively, without the per-iteration scopes, stack traffic
+    // and index conversions of the interpreted path. Two idioms exist:
+    //
+    // MAP (element-wise map, copy or fill, over arrays or matrix rows):
+    //     while (counter < limit): target[counter] = lhs op rhs; counter += step.
+    //
+    // REDUCTION (over array elements, matrix rows or ranges):
+    //     for (element in source): target op= element.
+    struct kernel {
+        enum class kind {
+            MAP,
+            REDUCTION,
+        };
+
+        // A value used by a kernel: a literal, a scalar variable or an
+        // element (row) of a structure indexed by the loop counter.
+        struct operand {
+            std::string id;
+            bool indexed = false;
+            scalar literal;
+        };
+
+        kind type;
+        std::string target;
+
+        // MAP
+        std::string counter;
+        op::comparison condition;
+        operand limit;
+        scalar step;
+        operand lhs;
+        operand rhs;
+        bool binary = false;
+        op::arithmetic operation;
+
+        // REDUCTION (source is empty for ranges)
+        std::string source;
+        std::string element;
+        op::assignment accumulation;
+    };
+
+    // Accesses 'x[counter]', 'x[counter, j]' or 'x[j, counter]' inside a
+    // 'while (counter < limit)' loop that can be proven to stay in bounds
+    // once the loop starts. The proof holds when the counter only grows
+    // (it is only changed by 'counter += k' commands, k > 0, at the top of
+    // the body), the accesses happen before any increment, and neither the
+    // structures nor the limit can be redeclared or resized by the body
+    // (no declarations of those names, no whole assignments and no
+    // function calls). It then suffices to check, at the beginning of the
+    // loop, that 0 <= counter and limit <= size (limit < size for '<=').
+    struct proof {
+        struct access {
+            var_id* vid;
+            // 0: row (or array) index, 1: column index
+            size_t slot;
+        };
+
+        std::string counter;
+        op::comparison condition;
+        kernel::operand limit;
+        std::vector<access> accesses;
+    };
+
+    namespace optimizer {
+        using node_ptr = std::shared_ptr<ast::node<evaluator>>;
+
+        // Tries to recognize a 'while' loop as a MAP kernel.
+        std::shared_ptr<kernel> recognize(const loop&,
+                                          std::array<node_ptr, 2>&);
+        // Collects the accesses of a 'while' loop that can skip checks.
+        std::shared_ptr<proof> prove(const loop&, std::array<node_ptr, 2>&);
+        // Tries to recognize a 'for' loop as a REDUCTION kernel.
+        std::shared_ptr<kernel> recognize(const for_it&,
+                                          std::array<node_ptr, 2>&);
+    }
+}
+
+#endif /* FALK_OPTIMIZER_HPP */
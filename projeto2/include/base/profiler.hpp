@@ -0,0 +1,82 @@
+#ifndef FALK_PROFILER_HPP
+#define FALK_PROFILER_HPP
+
+#include <ostream>
+#include <string>
+
+namespace falk {
+    // Sampling profiler (falk --profile). While running, a timer (SIGPROF)
+    // samples the source line being evaluated and the stack of function
+    // calls; at exit they are reported as hot lines, hot functions and a
+    // call tree. When disabled, markers and frames cost a flag test.
+    namespace profiler {
+        extern bool enabled;
+        // whether markers keep the line being evaluated (set by start(),
+        // and by other tools that need the line)
+        extern bool tracking;
+
+        // allocates the samples and starts the timer
+        void start();
+        // stops the timer
+        void stop();
+        // prints the samples taken
+        void report(std::ostream&);
+
+        // line being evaluated, 0 if none
+        extern volatile unsigned line;
+        // registers a function name, returning its id
+        unsigned intern(const std::string&);
+        void push(unsigned);
+        void pop();
+
+        // Marks a line as being evaluated while alive
+        class marker {
+         public:
+            explicit marker(unsigned where) {
+                if (tracking && where) {
+                    previous = line;
+                    line = where;
+                    active = true;
+                }
+            }
+
+            ~marker() {
+                if (active) {
+                    line = previous;
+                }
+            }
+
+            marker(const marker&) = delete;
+            marker& operator=(const marker&) = delete;
+
+         private:
+            unsigned previous;
+            bool active = false;
+        };
+
+        // Marks a function call while alive
+        class frame {
+         public:
+            explicit frame(const std::string& name) {
+                if (enabled) {
+                    push(intern(name));
+                    active = true;
+                }
+            }
+
+            ~frame() {
+                if (active) {
+                    pop();
+                }
+            }
+
+            frame(const frame&) = delete;
+            frame& operator=(const frame&) = delete;
+
+         private:
+            bool active = false;
+        };
+    }
+}
+
+#endif /* FALK_PROFILER_HPP */
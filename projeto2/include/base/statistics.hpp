@@ -0,0 +1,174 @@
+#ifndef FALK_STATISTICS_HPP
+#define FALK_STATISTICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+#include "operators.hpp"
+#include "types.hpp"
+
+namespace falk {
+    // Counters of the work done by the interpreter (falk --stats), printed
+    // at exit. They are only collected while enabled: otherwise each probe
+    // costs the test of a flag.
+    namespace stats {
+        extern bool enabled;
+
+        enum class event {
+            ARRAY_COPY,
+            MATRIX_COPY,
+            SCOPE_OPEN,
+            SCOPE_CLOSE,
+            LOOKUP,
+            COUNT,
+        };
+
+        extern std::atomic<uint64_t> events[size_t(event::COUNT)];
+        // bytes allocated, indexed by structural::type
+        extern std::atomic<uint64_t> allocated[4];
+
+        inline void count(event e) {
+            if (enabled) {
+                events[size_t(e)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        inline void allocation(structural::type type, size_t bytes) {
+            if (enabled) {
+                allocated[size_t(type)].fetch_add(bytes,
+                                                  std::memory_order_relaxed);
+            }
+        }
+
+        // Evaluations of the nodes holding a given kind of value. The total
+        // time includes the nodes below them, the self time does not.
+        struct node_kind {
+            std::string name;
+            uint64_t count = 0;
+            uint64_t total_ns = 0;
+            uint64_t self_ns = 0;
+        };
+
+        // registers a node kind; the result is never invalidated
+        node_kind& record(const std::string&);
+        // readable name of a type
+        std::string demangle(const char*);
+        // readable name of an operator
+        std::string symbol(const std::type_info&, int, size_t);
+
+        template<typename T>
+        struct name_of {
+            static std::string get() {
+                return demangle(typeid(T).name());
+            }
+        };
+
+        template<typename Type, Type OP, size_t N>
+        struct name_of<op::callback<Type, OP, N>> {
+            static std::string get() {
+                return symbol(typeid(Type), static_cast<int>(OP), N);
+            }
+        };
+
+        template<typename T>
+        node_kind& kind() {
+            static auto& result = record(name_of<T>::get());
+            return result;
+        }
+
+        // Measures the evaluation of a node while alive. Measurements nest,
+        // so that the time of inner nodes is taken from the outer ones.
+        class measurement {
+         public:
+            explicit measurement(node_kind* target) : target{target} {
+                if (target) {
+                    start();
+                }
+            }
+
+            ~measurement() {
+                if (target) {
+                    stop();
+                }
+            }
+
+            measurement(const measurement&) = delete;
+            measurement& operator=(const measurement&) = delete;
+
+         private:
+            node_kind* target;
+            measurement* outer;
+            uint64_t started;
+            uint64_t inner_ns = 0;
+
+            void start();
+            void stop();
+        };
+
+        template<typename T>
+        class probe : public measurement {
+         public:
+            probe() : measurement{enabled ? &kind<T>() : nullptr} { }
+        };
+
+        // Base of values whose copies are counted (as the given event)
+        template<event E>
+        struct counted {
+            counted() = default;
+            counted(counted&&) = default;
+            counted& operator=(counted&&) = default;
+
+            counted(const counted&) {
+                count(E);
+            }
+
+            counted& operator=(const counted&) {
+                count(E);
+                return *this;
+            }
+        };
+
+        // Allocator which accounts the memory of a structural type
+        template<typename T, structural::type S>
+        struct allocator {
+            using value_type = T;
+
+            template<typename U>
+            struct rebind {
+                using other = allocator<U, S>;
+            };
+
+            allocator() = default;
+            template<typename U>
+            allocator(const allocator<U, S>&) { }
+
+            T* allocate(size_t n) {
+                allocation(S, n * sizeof(T));
+                return std::allocator<T>().allocate(n);
+            }
+
+            void deallocate(T* p, size_t n) {
+                std::allocator<T>().deallocate(p, n);
+            }
+
+            template<typename U>
+            bool operator==(const allocator<U, S>&) const {
+                return true;
+            }
+
+            template<typename U>
+            bool operator!=(const allocator<U, S>&) const {
+                return false;
+            }
+        };
+
+        // prints everything collected so far
+        void report(std::ostream&);
+    }
+}
+
+#endif /* FALK_STATISTICS_HPP */
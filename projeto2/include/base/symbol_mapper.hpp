@@ -39,6 +39,21 @@ namespace falk {
         symbol::type type_of(const std::string&) const;
 
         void update_result(variable);
+
+        // calls f(id, depth, value) for each variable, from the outermost
+        // scope (depth 0) to the innermost
+        template<typename F>
+        void for_each_variable(F&& f) const {
+            size_t depth = 0;
+            for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+                for (auto& symbol : it->symbol_table) {
+                    if (symbol.second == symbol::type::VARIABLE) {
+                        f(symbol.first, depth, it->variables.at(symbol.first));
+                    }
+                }
+                ++depth;
+            }
+        }
      private:
         std::list<scope> scopes;
     };
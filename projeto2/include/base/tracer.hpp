@@ -0,0 +1,95 @@
+#ifndef FALK_TRACER_HPP
+#define FALK_TRACER_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace falk {
+    class array;
+    class matrix;
+    class variable;
+
+    // Chrome trace-event output (falk --trace file). Spans of function
+    // calls, top-level commands, large native kernels and the parts they
+    // split among threads are kept in a buffer per thread and written at
+    // exit as JSON, which trace viewers (chrome://tracing, Perfetto) can
+    // open.
+    namespace trace {
+        extern bool enabled;
+        // kernels working on fewer elements are not traced
+        constexpr size_t MIN_ELEMENTS = 4096;
+
+        // starts tracing into the given file
+        void start(const std::string&);
+        // writes the events of every thread, returns false on failure
+        bool finish();
+
+        // args are JSON object members, see field()
+        void begin(const std::string& name, const std::string& args);
+        void end(const std::string& args);
+
+        // "key": "value", to compose the arguments of a span
+        std::string field(const std::string& key, const std::string& value);
+        // "scalar", "array[n]", "matrix[r, c]" or "dict{n}"
+        std::string shape(const array&);
+        std::string shape(const matrix&);
+        std::string shape(const variable&);
+        // elements of an array, matrix or dict (0 for scalars)
+        size_t elements(const variable&);
+
+        // A span while alive. Names and arguments are only built when
+        // tracing, the latter by calling the given function.
+        class span {
+         public:
+            template<typename Name>
+            explicit span(const Name& name) {
+                if (enabled) {
+                    open(name, std::string());
+                }
+            }
+
+            template<typename Name, typename F>
+            span(const Name& name, F&& args) {
+                if (enabled) {
+                    open(name, args());
+                }
+            }
+
+            // a kernel, traced if it works on at least MIN_ELEMENTS
+            template<typename Name, typename F>
+            span(const Name& name, size_t elements, F&& args) {
+                if (enabled && elements >= MIN_ELEMENTS) {
+                    open(name, args());
+                }
+            }
+
+            ~span() {
+                if (active) {
+                    trace::end(closing);
+                }
+            }
+
+            span(const span&) = delete;
+            span& operator=(const span&) = delete;
+
+            // adds arguments known only after the span began
+            template<typename F>
+            void annotate(F&& args) {
+                if (active) {
+                    closing = args();
+                }
+            }
+
+         private:
+            bool active = false;
+            std::string closing;
+
+            void open(const std::string& name, const std::string& args) {
+                trace::begin(name, args);
+                active = true;
+            }
+        };
+    }
+}
+
+#endif /* FALK_TRACER_HPP */
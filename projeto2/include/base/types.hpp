@@ -9,6 +9,7 @@ namespace falk {
             REAL,
             COMPLEX,
             BOOL,
+            INT,
         };
     }
 
@@ -17,6 +18,7 @@ namespace falk {
             SCALAR,
             ARRAY,
             MATRIX,
+            DICT,
         };
     }
 
@@ -44,8 +46,9 @@ namespace std {
 namespace falk {
     const std::unordered_map<falk::type, unsigned> priority = {
         {falk::type::BOOL, 0},
-        {falk::type::REAL, 1},
-        {falk::type::COMPLEX, 2},
+        {falk::type::INT, 1},
+        {falk::type::REAL, 2},
+        {falk::type::COMPLEX, 3},
     };
 
     inline type resolve_types(type t1, type t2) {
@@ -53,6 +56,8 @@ namespace falk {
             return type::COMPLEX;
         } else if (t1 == type::REAL || t2 == type::REAL) {
             return type::REAL;
+        } else if (t1 == type::INT || t2 == type::INT) {
+            return type::INT;
         }
         return type::BOOL;
     }
@@ -0,0 +1,29 @@
+#ifndef FALK_LIB_ARGUMENTS_HPP
+#define FALK_LIB_ARGUMENTS_HPP
+
+#include "base/builtins.hpp"
+#include "types/array.hpp"
+#include "types/scalar.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Evaluate an argument of a builtin, reporting an error (on
+        // behalf of the named function) if it has the wrong shape.
+        // Return false on errors, which the caller must then propagate.
+        bool array_of(evaluator&, const builtins::node_ptr&,
+                      const std::string&, array&);
+        bool scalar_of(evaluator&, const builtins::node_ptr&,
+                       const std::string&, scalar&);
+        // evaluates an optional flag at the given position, false if
+        // it is absent
+        bool flag_of(evaluator&, const arguments&, size_t,
+                     const std::string&, bool&);
+        // retrieves the name of the user function passed as argument
+        bool function_of(evaluator&, const builtins::node_ptr&,
+                         const std::string&, std::string&);
+    }
+}
+
+#endif /* FALK_LIB_ARGUMENTS_HPP */
@@ -0,0 +1,22 @@
+#ifndef FALK_LIB_CONTAINERS_HPP
+#define FALK_LIB_CONTAINERS_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // append(a, x): adds x to the end of array a (or row x to
+        // matrix a), in amortized constant time
+        void append(evaluator&, arguments&);
+        // pop(a): removes and returns the last element (row) of a
+        void pop(evaluator&, arguments&);
+        // extend(a, b): appends all elements (rows) of b to a
+        void extend(evaluator&, arguments&);
+        // reserve(a, n): reserves space for n elements (rows) in a
+        void reserve(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_CONTAINERS_HPP */
@@ -0,0 +1,32 @@
+#ifndef FALK_LIB_CONVOLUTION_HPP
+#define FALK_LIB_CONVOLUTION_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Convolutions of arrays (conv) and matrices (conv2), and
+        // stencils (stencil), which apply a kernel without reversing it
+        // (a correlation).
+        //
+        // The optional mode selects the part of the result: 0 (full,
+        // the default of conv and conv2) keeps every element to which
+        // the kernel contributes, 1 (same, the default of stencil) the
+        // central part with the shape of the input and 2 (valid) only
+        // the elements computed without padding.
+        //
+        // Small kernels are applied directly, by tiles of the result;
+        // large ones through the FFT, when its estimated cost is lower.
+
+        // conv(a, k[, mode])
+        void conv(evaluator&, arguments&);
+        // conv2(m, k[, mode])
+        void conv2(evaluator&, arguments&);
+        // stencil(x, k[, mode]): x and k both arrays or both matrices
+        void stencil(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_CONVOLUTION_HPP */
@@ -0,0 +1,27 @@
+#ifndef FALK_LIB_DICTS_HPP
+#define FALK_LIB_DICTS_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // todict(k, v): dict mapping each element of array k to the
+        // element (row) of v at the same position
+        void todict(evaluator&, arguments&);
+        // has(d, k): whether key k is in dict d
+        void has(evaluator&, arguments&);
+        // get(d, k, x): the value of key k in d, or x if it is missing
+        void get(evaluator&, arguments&);
+        // remove(d, k): removes key k from dict d
+        void remove(evaluator&, arguments&);
+        // keys(d): array with the keys of d, in insertion order
+        void keys(evaluator&, arguments&);
+        // values(d): array (or matrix) with the values of d, in
+        // insertion order
+        void values(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_DICTS_HPP */
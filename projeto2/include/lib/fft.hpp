@@ -0,0 +1,47 @@
+#ifndef FALK_LIB_FFT_HPP
+#define FALK_LIB_FFT_HPP
+
+#include <complex>
+#include <vector>
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Discrete Fourier transforms of arrays (fft, ifft, rfft) and of
+        // matrices (fft2, ifft2), always with complex results. The
+        // inverse transforms are normalized by the number of elements.
+        //
+        // Sizes made of small prime factors are transformed by a mixed
+        // radix Stockham FFT; other sizes go through Bluestein's
+        // algorithm, with a power of 2 FFT. The twiddle factors of each
+        // size are computed once and kept in a plan.
+
+        // fft(x)
+        void fft(evaluator&, arguments&);
+        // ifft(x)
+        void ifft(evaluator&, arguments&);
+        // rfft(x): the first n / 2 + 1 coefficients of the transform of
+        // an array of n real numbers (the others are their conjugates)
+        void rfft(evaluator&, arguments&);
+        // fft2(m)
+        void fft2(evaluator&, arguments&);
+        // ifft2(m)
+        void ifft2(evaluator&, arguments&);
+
+        namespace spectral {
+            using complex = std::complex<double>;
+
+            // transforms a sequence in place; the inverse transform is
+            // normalized
+            void forward(std::vector<complex>&);
+            void inverse(std::vector<complex>&);
+            // the same, for a matrix stored in row-major order
+            void forward2(std::vector<complex>&, size_t rows, size_t columns);
+            void inverse2(std::vector<complex>&, size_t rows, size_t columns);
+        }
+    }
+}
+
+#endif /* FALK_LIB_FFT_HPP */
@@ -0,0 +1,31 @@
+#ifndef FALK_LIB_FUNCTIONAL_HPP
+#define FALK_LIB_FUNCTIONAL_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Higher-order functions, which call back a user function
+        // (passed by name) for each element or row, in order. The calls
+        // run one at a time, on the calling thread: evaluating a function
+        // mutates its AST (analyses cached in the nodes) and the scopes
+        // of the evaluator, so the calls cannot be split among workers.
+
+        // map(f, x): f applied to each element of an array or matrix,
+        // keeping its shape; f must return scalars
+        void map(evaluator&, arguments&);
+        // map_rows(f, m): f applied to each row of a matrix, giving an
+        // array if f returns scalars or a matrix if it returns arrays
+        // (all of the same size)
+        void map_rows(evaluator&, arguments&);
+        // reduce(f, x, init): f(f(f(init, x0), x1), ...), over the
+        // elements of an array or the rows of a matrix
+        void reduce(evaluator&, arguments&);
+        // filter(f, a): the elements of an array for which f is true
+        void filter(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_FUNCTIONAL_HPP */
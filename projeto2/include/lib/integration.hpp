@@ -0,0 +1,28 @@
+#ifndef FALK_LIB_INTEGRATION_HPP
+#define FALK_LIB_INTEGRATION_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Numerical integration of user functions, which are passed by
+        // name and called back for each evaluation.
+
+        // quad(f, a, b[, tol]): integral of f(x) from a to b, by adaptive
+        // Gauss-Kronrod (7, 15) quadrature, bisecting the interval with
+        // the largest error estimate until the total estimate is below
+        // tol (absolute or relative, 1e-10 by default)
+        void quad(evaluator&, arguments&);
+        // ode_rk45(f, y0, t0, t1[, rtol[, atol]]): solution of
+        // y' = f(t, y), y(t0) = y0 (a scalar or array), by the
+        // Dormand-Prince method with adaptive steps. Returns a matrix
+        // with a row [t, y] for each step taken, t0 and t1 included.
+        // The tolerances are 1e-6 (relative) and 1e-9 (absolute) by
+        // default.
+        void ode_rk45(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_INTEGRATION_HPP */
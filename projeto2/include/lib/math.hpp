@@ -0,0 +1,39 @@
+#ifndef FALK_LIB_MATH_HPP
+#define FALK_LIB_MATH_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Elementary functions, applied element-wise to scalars, arrays
+        // and matrices. Integers and booleans are taken as reals (except
+        // by abs and floor, which keep integers exact).
+        //
+        // exp, log, sin and cos evaluate reals with polynomial
+        // approximations over contiguous buffers. Measured against the
+        // exact results (2 million random arguments per range), exp and
+        // log stay within 1 ulp, sin and cos within 1.5 ulp for
+        // |x| <= 10 and 2.5 ulp for |x| <= 1e5. Other arguments (|x| > 708
+        // for exp, |x| > 1e5 or results near 0 for sin and cos, non-normal
+        // numbers for log) and complex numbers use the standard library,
+        // which strict_math(true) makes all evaluations use.
+        //
+        // log and sqrt of negative reals are NaN, as in the standard
+        // library; complex arguments give complex results.
+        void exp(evaluator&, arguments&);
+        void log(evaluator&, arguments&);
+        void sin(evaluator&, arguments&);
+        void cos(evaluator&, arguments&);
+        void sqrt(evaluator&, arguments&);
+        // abs(x): magnitude, which is real for complex numbers
+        void abs(evaluator&, arguments&);
+        // floor(x): not defined for complex numbers
+        void floor(evaluator&, arguments&);
+        // strict_math(b): whether to use only the standard library
+        void strict_math(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_MATH_HPP */
@@ -0,0 +1,65 @@
+#ifndef FALK_LIB_PARALLEL_HPP
+#define FALK_LIB_PARALLEL_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "base/tracer.hpp"
+
+namespace falk {
+    namespace lib {
+        // inputs with at least this many elements are split among
+        // threads
+        constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+        constexpr size_t MAX_THREADS = 8;
+
+        // number of threads to use for n elements
+        inline size_t workers(size_t n) {
+            if (n < PARALLEL_THRESHOLD) {
+                return 1;
+            }
+            size_t available = std::thread::hardware_concurrency();
+            return std::max<size_t>(1, std::min(available, MAX_THREADS));
+        }
+
+        // calls f(t) for each t in [0, count), each call in its own
+        // thread; when split, each call is traced as a span of the thread
+        // running it
+        template<typename F>
+        void parallel(size_t count, F&& f) {
+            if (count <= 1) {
+                f(0);
+                return;
+            }
+            auto part = [&](size_t t) {
+                trace::span traced{"part", [&] {
+                    return trace::field("part", std::to_string(t + 1) + " of "
+                                              + std::to_string(count));
+                }};
+                f(t);
+            };
+            std::vector<std::thread> threads;
+            for (size_t t = 1; t < count; t++) {
+                threads.emplace_back(part, t);
+            }
+            part(0);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // calls f(i) for each i in [0, n), split in contiguous chunks
+        template<typename F>
+        void parallel_for(size_t n, F&& f) {
+            auto count = workers(n);
+            parallel(count, [&](size_t t) {
+                auto end = n * (t + 1) / count;
+                for (auto i = n * t / count; i < end; i++) {
+                    f(i);
+                }
+            });
+        }
+    }
+}
+
+#endif /* FALK_LIB_PARALLEL_HPP */
@@ -0,0 +1,29 @@
+#ifndef FALK_LIB_RANDOM_HPP
+#define FALK_LIB_RANDOM_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Random numbers from a global stream, which starts at seed 0.
+        // The stream is counter-based: the k-th number drawn after
+        // seed(s) is a hash of s and k, so large fills are split among
+        // threads and still give the same numbers in any environment.
+        //
+        // Each generator returns a scalar when called without sizes, an
+        // array when given a size n and a matrix when given r and c.
+
+        // seed(s): restarts the stream from integer seed s
+        void seed(evaluator&, arguments&);
+        // rand([n[, c]]): uniform reals in [0, 1)
+        void rand(evaluator&, arguments&);
+        // randn([n[, c]]): reals from the standard normal distribution
+        void randn(evaluator&, arguments&);
+        // randint(a, b[, n[, c]]): uniform integers in [a, b]
+        void randint(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_RANDOM_HPP */
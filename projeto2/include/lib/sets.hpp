@@ -0,0 +1,34 @@
+#ifndef FALK_LIB_SETS_HPP
+#define FALK_LIB_SETS_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Set operations over arrays, with elements compared as dict keys
+        // (see keys.hpp). Results keep the order of first occurrence,
+        // unless the optional last argument s is true: then they are
+        // sorted, and unique() and value_counts() group by sorting
+        // instead of hashing.
+
+        // unique(a[, s]): the distinct elements of a
+        void unique(evaluator&, arguments&);
+        // union(a, b[, s]): the distinct elements of a and b
+        void unite(evaluator&, arguments&);
+        // intersect(a, b[, s]): the distinct elements of a also in b
+        void intersect(evaluator&, arguments&);
+        // setdiff(a, b[, s]): the distinct elements of a not in b
+        void setdiff(evaluator&, arguments&);
+        // ismember(x, b): whether x (or each element of array x) is in b
+        void ismember(evaluator&, arguments&);
+        // 'x in b', as ismember(x, b) with errors naming the operator
+        void member(evaluator&, arguments&);
+        // value_counts(a[, s]): dict from each distinct element of a to
+        // its number of occurrences
+        void value_counts(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_SETS_HPP */
@@ -0,0 +1,28 @@
+#ifndef FALK_LIB_SORTING_HPP
+#define FALK_LIB_SORTING_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Sorting builtins. Elements are ordered as in keys.hpp (complex
+        // numbers by real part, then imaginary part, and NaNs last), all
+        // sorts are stable and the optional flag d sorts in descending
+        // order.
+
+        // sort(a[, d]): the elements of a, sorted
+        void sort(evaluator&, arguments&);
+        // argsort(a[, d]): the positions of the elements of a, in the
+        // order that sorts them
+        void argsort(evaluator&, arguments&);
+        // sortrows(m, c[, d]): the rows of m, sorted by column c
+        void sortrows(evaluator&, arguments&);
+        // topk(a, k[, s]): the k largest elements of a, from the largest
+        // down (the k smallest, from the smallest up, if s is true)
+        void topk(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_SORTING_HPP */
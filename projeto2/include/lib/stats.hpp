@@ -0,0 +1,39 @@
+#ifndef FALK_LIB_STATS_HPP
+#define FALK_LIB_STATS_HPP
+
+#include "base/builtins.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Descriptive statistics of arrays, or of each column of a
+        // matrix (giving an array). Only mean accepts complex numbers.
+        //
+        // Moments are computed in a single pass with Welford's updates;
+        // large inputs are split among threads and the partial results
+        // merged. Quantiles select elements in linear time instead of
+        // sorting.
+
+        // mean(x)
+        void mean(evaluator&, arguments&);
+        // variance(x): sample variance (normalized by n - 1)
+        void variance(evaluator&, arguments&);
+        // std(x): sample standard deviation
+        void stdev(evaluator&, arguments&);
+        // median(x)
+        void median(evaluator&, arguments&);
+        // quantile(x, q): quantile q (or quantiles, if q is an array) of
+        // x, interpolated linearly between elements
+        void quantile(evaluator&, arguments&);
+        // cov(m): covariance matrix of the columns of m
+        // cov(a, b): covariance of arrays a and b
+        void cov(evaluator&, arguments&);
+        // hist(x, n[, lo, hi]): counts of the elements of x in n bins of
+        // the same width between lo and hi (the smallest and largest
+        // elements by default); elements outside are not counted
+        void hist(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_STATS_HPP */
@@ -0,0 +1,47 @@
+#ifndef FALK_LIB_WORKSPACE_HPP
+#define FALK_LIB_WORKSPACE_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/builtins.hpp"
+#include "base/symbol_mapper.hpp"
+
+namespace falk {
+    namespace lib {
+        using arguments = builtins::arguments;
+
+        // Memory held by the variables of all scopes, for the :whos
+        // command and the whos() builtin.
+        //
+        // Values own their storage (there are no views, shared buffers
+        // or mapped files), so the bytes of a variable are the object,
+        // its holder and the capacity of its containers.
+        struct whos_entry {
+            std::string name;
+            // 0 for the global scope
+            size_t depth;
+            structural::type s_type;
+            // meaningless for dicts, whose values have their own types
+            falk::type f_type;
+            size_t rows;
+            size_t columns;
+            size_t bytes;
+        };
+
+        // the variables of every scope, from the outermost
+        std::vector<whos_entry> variables(const symbol_mapper&);
+        // prints a table of the variables, with totals
+        void report(std::ostream&, const symbol_mapper&);
+
+        // whos(): matrix with a row per variable (in the order of :whos)
+        // holding its structural type (0 scalar, 1 array, 2 matrix,
+        // 3 dict), fundamental type (0 real, 1 complex, 2 bool, 3 int,
+        // -1 for dicts), rows and columns (1 x n for arrays, n x 2 for
+        // dicts) and bytes
+        void whos(evaluator&, arguments&);
+    }
+}
+
+#endif /* FALK_LIB_WORKSPACE_HPP */
@@ -9,7 +9,6 @@ namespace lpi {
      public:
         virtual void increase_location(unsigned) = 0;
         virtual unsigned location() const = 0;
-        virtual void count_new_line() = 0;
         virtual unsigned line_count() const = 0;
         virtual void close_file() = 0;
     };
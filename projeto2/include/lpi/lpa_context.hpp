@@ -17,7 +17,6 @@ namespace lpi {
 
         void console_mode(bool);
 
-        void count_new_line() override;
         unsigned line_count() const override;
         int run();
         void clear();
@@ -28,7 +27,6 @@ namespace lpi {
         Parser parser;
         Analyser analyser;
         unsigned loc = 0;
-        unsigned lines = 0;
         std::ifstream file;
 
         void increase_location(unsigned) override;
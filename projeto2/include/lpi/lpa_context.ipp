@@ -32,14 +32,10 @@ void lpi::lpa_context<L,P,A>::close_file() {
     switch_input_stream(&std::cin);
 }
 
-template<typename L, typename P, typename A>
-void lpi::lpa_context<L,P,A>::count_new_line() {
-    lines++;
-}
-
 template<typename L, typename P, typename A>
 unsigned lpi::lpa_context<L,P,A>::line_count() const {
-    return lines;
+    // error messages count lines from 0 (the reports, from 1)
+    return lexer.line() - 1;
 }
 
 template<typename L, typename P, typename A>
@@ -22,9 +22,28 @@ namespace falk {
                 analyser{analyser}, context{context} {}
     	virtual ~scanner() {}
     	virtual parser::symbol_type next_token();
+
+        // line of the last token read, counted from 1
+        unsigned line() const {
+            return position.begin.line;
+        }
     private:
         falk::analyser& analyser;
         lpi::context& context;
+        // location of the last token read
+        location position;
+
+        // moves the location over the text of a token
+        void advance(const char* text, size_t length) {
+            position.step();
+            for (size_t i = 0; i < length; i++) {
+                if (text[i] == '\n') {
+                    position.lines(1);
+                } else {
+                    position.columns(1);
+                }
+            }
+        }
     };
 }
 
@@ -2,54 +2,92 @@
 #ifndef FALK_EV_ARRAY_HPP
 #define FALK_EV_ARRAY_HPP
 
+#include <iterator>
 #include <ostream>
-#include <deque>
+#include <vector>
 #include "base/errors.hpp"
+#include "base/operators.hpp"
+#include "base/statistics.hpp"
 #include "scalar.hpp"
 
 namespace falk {
     class matrix;
 
-    class array {
+    // Elements of integer arrays are kept densely, as int64 values, so
+    // that the element-wise kernels work on plain integers. Other arrays,
+    // and integer ones once an element is accessed by reference, keep
+    // scalars. Reads give scalars by value, whatever the storage.
+    class array : stats::counted<stats::event::ARRAY_COPY> {
      public:
+        class const_iterator;
+
         explicit array(bool flag = false) : fail(flag) { }
-        array(const scalar& size, falk::type type)
-        : values(size.real(), 0), value_type{type} { }
+        array(const scalar& size, falk::type type);
 
-        auto begin() const {
-            return values.cbegin();
-        }
+        const_iterator begin() const;
+        const_iterator end() const;
 
+        // the iterators of a dense array are taken as scalars
         auto begin() {
+            spill();
             return values.begin();
         }
 
-        auto end() const {
-            return values.cend();
-        }
-
         auto end() {
+            spill();
             return values.end();
         }
 
         size_t size() const {
-            return values.size();
+            return compact ? packed.size() : values.size();
         }
 
+        // a reference to the element, for arrays of scalars
         scalar& operator[](size_t index) {
+            spill();
             return values[index];
         }
 
-        const scalar& operator[](size_t index) const {
-            return values.at(index);
+        scalar operator[](size_t index) const {
+            return compact ? scalar(packed.at(index)) : values.at(index);
+        }
+
+        // access without bounds checking, for indexes known to be valid
+        scalar unchecked(size_t index) const {
+            return compact ? scalar(packed[index]) : values[index];
+        }
+
+        // replaces an element (which must exist), keeping integers dense
+        void set(size_t index, const scalar& value);
+
+        void push_back(const scalar& value);
+
+        // removes the last element, which must exist
+        scalar pop_back();
+
+        void extend(const array& other);
+
+        // false (leaving the array as it was) if the capacity cannot be
+        // allocated
+        bool reserve(size_t capacity);
+
+        size_t capacity() const {
+            return compact ? packed.capacity() : values.capacity();
+        }
+
+        // bytes taken by each element
+        size_t element_size() const {
+            return compact ? sizeof(int64_t) : sizeof(scalar);
         }
 
-        void push_front(const scalar& value) {
-            values.push_front(prepare(value));
+        // whether the elements are stored as int64 values, given by
+        // integers()
+        bool dense() const {
+            return compact;
         }
 
-        void push_back(const scalar& value) {
-            values.push_back(prepare(value));
+        const int64_t* integers() const {
+            return packed.data();
         }
 
         void coerce_to(falk::type);
@@ -59,6 +97,9 @@ namespace falk {
         }
 
         void inner_type(falk::type type) {
+            if (type != falk::type::INT) {
+                spill();
+            }
             value_type = type;
         }
 
@@ -134,14 +175,101 @@ namespace falk {
         array& operator|=(const matrix&);
 
      private:
-        std::deque<scalar> values;
+        std::vector<scalar,
+                    stats::allocator<scalar, structural::type::ARRAY>> values;
+        std::vector<int64_t,
+                    stats::allocator<int64_t, structural::type::ARRAY>> packed;
+        bool compact = false;
         bool fail = false;
         bool print = true;
         falk::type value_type = falk::type::BOOL;
 
         scalar prepare(const scalar&);
+        // moves the elements to scalars
+        void spill();
+        // makes an integer array holding other values (results too large
+        // for an integer, or of a real operand) an array of their type
+        void settle();
+        void settle(falk::type);
+        // applies an integer kernel to the elements of two dense arrays,
+        // changing nothing if it fails
+        bool combine(op::arithmetic, const array&);
     };
 
+    // Iterates over the elements of an array, by value
+    class array::const_iterator {
+     public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = scalar;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const scalar*;
+        using reference = scalar;
+
+        const_iterator(const array* owner, size_t index)
+        : owner{owner}, index{index} { }
+
+        scalar operator*() const {
+            return owner->unchecked(index);
+        }
+
+        scalar operator[](difference_type offset) const {
+            return owner->unchecked(index + offset);
+        }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        const_iterator& operator--() {
+            --index;
+            return *this;
+        }
+
+        const_iterator& operator+=(difference_type offset) {
+            index += offset;
+            return *this;
+        }
+
+        const_iterator operator+(difference_type offset) const {
+            return {owner, index + offset};
+        }
+
+        difference_type operator-(const const_iterator& other) const {
+            return difference_type(index) - difference_type(other.index);
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return index != other.index;
+        }
+
+     private:
+        const array* owner;
+        size_t index;
+    };
+
+    inline array::array(const scalar& size, falk::type type)
+    : value_type{type} {
+        if (type == falk::type::INT) {
+            packed.resize(size.real());
+            compact = true;
+        } else {
+            values.resize(size.real(), scalar(type));
+        }
+    }
+
+    inline array::const_iterator array::begin() const {
+        return {this, 0};
+    }
+
+    inline array::const_iterator array::end() const {
+        return {this, size()};
+    }
+
     inline array operator+(const array& lhs, const array& rhs) {
         auto copy = lhs;
         return copy += rhs;
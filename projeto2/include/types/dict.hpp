@@ -0,0 +1,95 @@
+
+#ifndef FALK_EV_DICT_HPP
+#define FALK_EV_DICT_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "array.hpp"
+#include "base/statistics.hpp"
+#include "hash_index.hpp"
+#include "scalar.hpp"
+#include "variable.hpp"
+
+namespace falk {
+    // Associative container from scalar keys to values (scalars, arrays
+    // or matrices), iterated in insertion order.
+    //
+    // Keys are compared by numeric value (see keys.hpp), as elements in
+    // set operations are: all NaNs are the same key.
+    //
+    // Entries are stored densely, in insertion order, and located through
+    // a hash_index.
+    class dict {
+     public:
+        explicit dict(bool flag = false) : fail{flag} { }
+
+        size_t size() const {
+            return count;
+        }
+
+        // returns the value of a key, or nullptr if it is not present
+        variable* find(const scalar&);
+        const variable* find(const scalar&) const;
+        // inserts or replaces the value of a key
+        void insert(const scalar&, variable);
+        // removes a key, returns false if it was not present
+        bool erase(const scalar&);
+
+        // calls f(key, value) for each entry, in insertion order
+        template<typename F>
+        void for_each(F&& f) const {
+            for (auto& e : entries) {
+                if (e.alive) {
+                    f(e.key, e.value);
+                }
+            }
+        }
+
+        array keys() const;
+
+        void set_error() {
+            fail = true;
+        }
+
+        bool error() const {
+            return fail;
+        }
+
+        bool printable() const {
+            return print;
+        }
+
+        static dict silent() {
+            dict d;
+            d.print = false;
+            return d;
+        }
+
+        constexpr structural::type type() const {
+            return structural::type::DICT;
+        }
+
+     private:
+        struct entry {
+            scalar key;
+            variable value;
+            bool alive;
+        };
+
+        std::vector<entry,
+                    stats::allocator<entry, structural::type::DICT>> entries;
+        hash_index index;
+        size_t count = 0;
+        bool fail = false;
+        bool print = true;
+
+        // slot of a key, or -1
+        int64_t locate(const scalar&, uint64_t) const;
+        void rehash();
+    };
+
+    std::ostream& operator<<(std::ostream&, const dict&);
+}
+
+#endif /* FALK_EV_DICT_HPP */
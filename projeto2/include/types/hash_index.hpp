@@ -0,0 +1,112 @@
+#ifndef FALK_EV_HASH_INDEX_HPP
+#define FALK_EV_HASH_INDEX_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace falk {
+    // Open addressing table mapping hashes to positions of a sequence
+    // stored elsewhere (entries of a dict, elements of an array...).
+    //
+    // Each slot has a control byte (empty, deleted or 7 bits of the
+    // hash) and probing reads the control bytes of 8 slots at once,
+    // comparing them with word-wide bit operations, so that most misses
+    // and hits cost a single memory access.
+    class hash_index {
+     public:
+        // slot holding a position p with the given hash and for which
+        // match(p) is true, or -1
+        template<typename Match>
+        int64_t locate(uint64_t hash, Match&& match) const;
+
+        uint32_t position(int64_t slot) const {
+            return slots[slot];
+        }
+
+        // stores a position, which must not be present yet
+        void place(uint64_t hash, uint32_t position);
+        void erase(int64_t slot);
+
+        // whether one more position can be placed without exceeding
+        // the maximum load (7/8 of the slots, including deleted ones)
+        bool fits() const {
+            return (used + 1) * 8 <= control.size() * 7;
+        }
+
+        // empties the index, making room for n positions
+        void reset(size_t n);
+
+        size_t capacity() const {
+            return control.size();
+        }
+
+     private:
+        static constexpr size_t GROUP = 8;
+        static constexpr uint8_t EMPTY = 0x80;
+        static constexpr uint8_t DELETED = 0xFE;
+        static constexpr uint64_t LSB = 0x0101010101010101;
+        static constexpr uint64_t MSB = 0x8080808080808080;
+
+        std::vector<uint8_t> control;
+        std::vector<uint32_t> slots;
+        size_t used = 0;
+
+        uint64_t load(size_t position) const {
+            uint64_t group;
+            std::memcpy(&group, control.data() + position, sizeof(group));
+            return group;
+        }
+
+        // bytes of a group equal to the given byte (may have false
+        // positives after a true match, filtered by the caller)
+        static uint64_t match(uint64_t group, uint8_t byte) {
+            auto x = group ^ (LSB * byte);
+            return (x - LSB) & ~x & MSB;
+        }
+
+        static uint64_t match_empty(uint64_t group) {
+            return group & ~(group << 6) & MSB;
+        }
+
+        // bytes of a group that are empty or deleted
+        static uint64_t match_free(uint64_t group) {
+            return group & MSB;
+        }
+
+        static size_t lowest(uint64_t mask) {
+            return __builtin_ctzll(mask) / 8;
+        }
+
+        static uint8_t fingerprint(uint64_t hash) {
+            return hash >> 57;
+        }
+    };
+
+    template<typename Match>
+    int64_t hash_index::locate(uint64_t hash, Match&& matches) const {
+        if (control.empty()) {
+            return -1;
+        }
+
+        auto mask = control.size() - 1;
+        auto tag = fingerprint(hash);
+        auto position = hash & mask & ~(GROUP - 1);
+        for (size_t step = 1; ; step++) {
+            auto group = load(position);
+            for (auto m = match(group, tag); m; m &= m - 1) {
+                auto slot = position + lowest(m);
+                if (control[slot] == tag && matches(slots[slot])) {
+                    return slot;
+                }
+            }
+
+            if (match_empty(group)) {
+                return -1;
+            }
+            position = (position + step * GROUP) & mask;
+        }
+    }
+}
+
+#endif /* FALK_EV_HASH_INDEX_HPP */
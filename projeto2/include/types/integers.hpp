@@ -0,0 +1,28 @@
+#ifndef FALK_EV_INTEGERS_HPP
+#define FALK_EV_INTEGERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "base/operators.hpp"
+
+namespace falk {
+    // Kernels over the dense int64 storage of arrays and matrices, written
+    // as plain loops that the compiler can vectorize. They fail (giving
+    // false, with the result left unspecified) when some result does not
+    // fit in 64 bits or is not an integer, in which case callers compute
+    // with scalars, which turn such results into reals.
+    namespace integers {
+        // result[i] = lhs[i] op rhs[i], for ADD, SUB, MULT and MOD (other
+        // operations always fail). At most one side may be 'single': a
+        // value applied to every element of the other. The result may be
+        // one of the operands.
+        bool apply(op::arithmetic, const int64_t* lhs, bool single_lhs,
+                   const int64_t* rhs, bool single_rhs, int64_t* result,
+                   size_t count);
+
+        // sum of the values, failing only if the total does not fit
+        bool sum(const int64_t*, size_t, int64_t& result);
+    }
+}
+
+#endif /* FALK_EV_INTEGERS_HPP */
@@ -0,0 +1,19 @@
+#ifndef FALK_EV_KEYS_HPP
+#define FALK_EV_KEYS_HPP
+
+#include <cstdint>
+#include "scalar.hpp"
+
+namespace falk {
+    // Scalars used as keys (of dicts and set operations). Keys are
+    // compared by numeric value: 1, 1.0 and true are the same key and
+    // -0.0 is the same as 0. All NaNs are the same key.
+    namespace keys {
+        uint64_t hash(const scalar&);
+        bool equal(const scalar&, const scalar&);
+        // total order: by real part, then imaginary part, NaNs last
+        bool less(const scalar&, const scalar&);
+    }
+}
+
+#endif /* FALK_EV_KEYS_HPP */
@@ -2,20 +2,29 @@
 #ifndef FALK_EV_MATRIX_HPP
 #define FALK_EV_MATRIX_HPP
 
-#include <deque>
+#include <vector>
 #include "array.hpp"
 #include "base/errors.hpp"
+#include "base/statistics.hpp"
 #include "scalar.hpp"
 
 namespace falk {
-    class matrix {
+    // Row-major; like arrays, integer matrices keep their elements as
+    // dense int64 values until one is accessed by reference.
+    class matrix : stats::counted<stats::event::MATRIX_COPY> {
      public:
         explicit matrix(bool = false);
         matrix(size_t, size_t);
         matrix(const scalar&, const scalar&, falk::type);
 
+        // a reference to the element, for matrices of scalars
         scalar& at(size_t, size_t);
-        const scalar& at(size_t, size_t) const;
+        scalar at(size_t, size_t) const;
+        // access without bounds checking, for indexes known to be valid
+        scalar& unchecked(size_t, size_t);
+        scalar unchecked(size_t, size_t) const;
+        // replaces an element (which must exist), keeping integers dense
+        void set(size_t, size_t, const scalar&);
         array row(size_t) const;
         array column(size_t) const;
 
@@ -23,7 +32,11 @@ namespace falk {
         matrix& assign_column(size_t, const array&);
 
         void push_back(const array&);
-        void push_front(const array&);
+        // removes the last row, which must exist
+        array pop_back();
+        // false (leaving the matrix as it was) if the capacity cannot be
+        // allocated
+        bool reserve(size_t rows, size_t columns);
         void set_error();
         bool error() const;
         bool printable() const;
@@ -32,6 +45,21 @@ namespace falk {
         std::pair<size_t, size_t> size() const;
         size_t row_count() const;
         size_t column_count() const;
+        size_t capacity() const;
+        // bytes taken by each element
+        size_t element_size() const;
+        falk::type inner_type() const;
+
+        // whether the elements are stored as int64 values, given by
+        // integers()
+        bool dense() const;
+        const int64_t* integers() const;
+
+        // the given operation between every element and an integer (on
+        // the left if 'reversed'), for dense matrices; false, leaving the
+        // result unchanged, if the elements or a result are not integers
+        bool broadcast(op::arithmetic, const scalar&, bool reversed,
+                       matrix& result) const;
 
         constexpr structural::type type() const {
             return structural::type::MATRIX;
@@ -73,7 +101,11 @@ namespace falk {
         matrix& operator|=(const matrix&);
 
      private:
-        std::deque<scalar> values;
+        std::vector<scalar,
+                    stats::allocator<scalar, structural::type::MATRIX>> values;
+        std::vector<int64_t,
+                    stats::allocator<int64_t, structural::type::MATRIX>> packed;
+        bool compact = false;
         static scalar invalid;
         size_t num_rows = 0;
         size_t num_columns = 0;
@@ -82,6 +114,15 @@ namespace falk {
         falk::type value_type = falk::type::BOOL;
 
         array prepare(const array&);
+        // moves the elements to scalars
+        void spill();
+        // makes an integer matrix holding other values a matrix of their
+        // type
+        void settle();
+        void settle(falk::type);
+        // applies an integer kernel to the elements of two dense matrices,
+        // changing nothing if it fails
+        bool combine(op::arithmetic, const matrix&);
     };
 
     const auto invalid_matrix = matrix(true);
@@ -93,6 +134,26 @@ namespace falk {
     inline bool matrix::printable() const {
         return print;
     }
+
+    inline size_t matrix::capacity() const {
+        return compact ? packed.capacity() : values.capacity();
+    }
+
+    inline size_t matrix::element_size() const {
+        return compact ? sizeof(int64_t) : sizeof(scalar);
+    }
+
+    inline bool matrix::dense() const {
+        return compact;
+    }
+
+    inline const int64_t* matrix::integers() const {
+        return packed.data();
+    }
+
+    inline falk::type matrix::inner_type() const {
+        return value_type;
+    }
     inline matrix matrix::silent() {
         matrix m;
         m.print = false;
@@ -381,10 +442,26 @@ namespace falk {
       values(rows * columns), num_rows{rows}, num_columns{columns} { }
 
     inline matrix::matrix(const scalar& rows, const scalar& columns, falk::type type):
-      values(rows.real() * columns.real(), 0),
       num_rows{static_cast<size_t>(rows.real())},
       num_columns{static_cast<size_t>(columns.real())},
-      value_type{type} { }
+      value_type{type} {
+        if (type == falk::type::INT) {
+            packed.resize(rows.real() * columns.real());
+            compact = true;
+        } else {
+            values.resize(rows.real() * columns.real(), scalar(type));
+        }
+    }
+
+    inline scalar& matrix::unchecked(size_t row, size_t column) {
+        spill();
+        return values[row * num_columns + column];
+    }
+
+    inline scalar matrix::unchecked(size_t row, size_t column) const {
+        auto index = row * num_columns + column;
+        return compact ? scalar(packed[index]) : values[index];
+    }
 
     inline bool matrix::error() const {
         return fail;
@@ -408,6 +485,7 @@ namespace falk {
                 at(i, j) = scalar::pow(at(i, j), rhs);
             }
         }
+        settle();
         return *this;
     }
 
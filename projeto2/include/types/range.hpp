@@ -0,0 +1,45 @@
+
+#ifndef FALK_EV_RANGE_HPP
+#define FALK_EV_RANGE_HPP
+
+#include "array.hpp"
+#include "scalar.hpp"
+
+namespace falk {
+    // Arithmetic progression 'start..stop:step' (stop excluded), used as
+    // a virtual array: elements are computed on access instead of being
+    // stored, so iterating over it takes constant memory.
+    class range {
+     public:
+        explicit range(bool flag = false) : fail{flag} { }
+        range(const scalar& start, const scalar& stop, const scalar& step);
+
+        size_t size() const {
+            return count;
+        }
+
+        scalar operator[](size_t) const;
+
+        // sum of all elements, in closed form
+        scalar sum() const;
+
+        falk::type inner_type() const {
+            return value_type;
+        }
+
+        bool error() const {
+            return fail;
+        }
+
+        array to_array() const;
+
+     private:
+        scalar start;
+        scalar step;
+        size_t count = 0;
+        falk::type value_type = falk::type::INT;
+        bool fail = false;
+    };
+}
+
+#endif /* FALK_EV_RANGE_HPP */
@@ -3,6 +3,7 @@
 #define FALK_EVALUATOR_RVALUE
 
 #include <complex>
+#include <cstdint>
 #include <vector>
 #include "base/errors.hpp"
 #include "base/types.hpp"
@@ -12,10 +13,14 @@ namespace falk {
     class matrix;
 
     // Class to capture all kinds of scalar possible.
+    // Integers are kept exactly in a 64-bit field, sharing the storage of
+    // the imaginary part; real() mirrors them (as a double) so code that
+    // only needs a number can ignore the type.
     class scalar {
      public:
         scalar(double);
         scalar(int);
+        scalar(int64_t);
         scalar(std::complex<double>);
         scalar(falk::type = falk::type::COMPLEX, double = 0, double = 0);
         scalar(bool);
@@ -24,8 +29,7 @@ namespace falk {
         std::complex<double> complex() const;
         double imag() const;
         double real() const;
-        double& imag();
-        double& real();
+        int64_t integer() const;
 
         void set_error();
         bool error() const;
@@ -34,8 +38,14 @@ namespace falk {
         static scalar invalid(fundamental::type = type::BOOL);
 
         falk::fundamental::type inner_type() const;
+        // converts to the given type, giving a value of no declared type
         void inner_type(falk::type);
 
+        // whether the type was declared (var x : int), in which case it is
+        // kept by assignments instead of widening integers to reals
+        bool fixed_type() const;
+        void fixed_type(bool);
+
         array to_array(size_t) const;
 
         constexpr structural::type type() const {
@@ -80,9 +90,26 @@ namespace falk {
      private:
         falk::fundamental::type _type;
         double _real = 0;
-        double _imag = 0;
+        union {
+            double _imag = 0;
+            // integers have no imaginary part
+            int64_t _integer;
+        };
         bool fail = false;
         bool print = true;
+        bool fixed = false;
+
+        // converts a double to integer, saturating on overflow
+        static int64_t truncate(double);
+        // keeps the invariants of integers after a change in _real
+        void normalize();
+        // stores an exact integer result, respecting the current type
+        scalar& store(int64_t);
+        // integers become reals instead of truncating non-integer values
+        void widen(falk::type);
+        // stores an integer result which does not fit in 64 bits: as a
+        // real, or saturated if the type was declared
+        scalar& overflow(double);
     };
 
     // Non-member functions
@@ -119,6 +146,10 @@ namespace falk {
     }
 
     inline scalar operator<(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() < rhs.integer();
+        }
+
         if (lhs.real() == rhs.real()) {
             return lhs.imag() < rhs.imag();
         }
@@ -126,6 +157,10 @@ namespace falk {
     }
 
     inline scalar operator>(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() > rhs.integer();
+        }
+
         if (lhs.real() == rhs.real()) {
             return lhs.imag() > rhs.imag();
         }
@@ -133,6 +168,10 @@ namespace falk {
     }
 
     inline scalar operator<=(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() <= rhs.integer();
+        }
+
         if (lhs.real() == rhs.real()) {
             return lhs.imag() <= rhs.imag();
         }
@@ -140,6 +179,10 @@ namespace falk {
     }
 
     inline scalar operator>=(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() >= rhs.integer();
+        }
+
         if (lhs.real() == rhs.real()) {
             return lhs.imag() >= rhs.imag();
         }
@@ -147,10 +190,16 @@ namespace falk {
     }
 
     inline scalar operator==(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() == rhs.integer();
+        }
         return lhs.real() == rhs.real() && lhs.imag() == rhs.imag();
     }
 
     inline scalar operator!=(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == type::INT && rhs.inner_type() == type::INT) {
+            return lhs.integer() != rhs.integer();
+        }
         return lhs.real() != rhs.real() || lhs.imag() != rhs.imag();
     }
 
@@ -291,17 +340,22 @@ namespace falk {
     inline scalar::scalar(int v):
       _type{falk::type::REAL}, _real{static_cast<double>(v)} { }
     
+    inline scalar::scalar(int64_t v):
+      _type{falk::type::INT}, _real{static_cast<double>(v)}, _integer{v} { }
+
     inline scalar::scalar(std::complex<double> v):
       _type{falk::type::COMPLEX}, _real{v.real()}, _imag{v.imag()} { }
     
     inline scalar::scalar(falk::type type, double real, double imag):
-      _type{type}, _real{real}, _imag{imag} { }
+      _type{type}, _real{real}, _imag{imag} {
+        normalize();
+    }
 
     inline scalar::scalar(bool v):
       _type{falk::type::BOOL}, _real{static_cast<double>(v)} { }
 
     inline std::complex<double> scalar::complex() const {
-        return {_real, _imag};
+        return {_real, imag()};
     }
 
     inline bool scalar::boolean() const {
@@ -309,19 +363,15 @@ namespace falk {
     }
 
     inline double scalar::imag() const {
-        return _imag;
+        return _type == falk::type::INT ? 0 : _imag;
     }
 
     inline double scalar::real() const {
         return _real;
     }
 
-    inline double& scalar::imag() {
-        return _imag;
-    }
-
-    inline double& scalar::real() {
-        return _real;
+    inline int64_t scalar::integer() const {
+        return _type == falk::type::INT ? _integer : truncate(_real);
     }
 
     inline falk::type scalar::inner_type() const {
@@ -329,7 +379,64 @@ namespace falk {
     }
 
     inline void scalar::inner_type(falk::type t) {
-        _type = t;
+        fixed = false;
+        if (t != _type) {
+            if (_type == falk::type::INT) {
+                _imag = 0;
+            }
+            _type = t;
+            normalize();
+        }
+    }
+
+    inline bool scalar::fixed_type() const {
+        return fixed;
+    }
+
+    inline void scalar::fixed_type(bool flag) {
+        fixed = flag;
+    }
+
+    inline int64_t scalar::truncate(double value) {
+        if (value != value) {
+            return 0;
+        } else if (value >= 9223372036854775807.0) {
+            return INT64_MAX;
+        } else if (value <= -9223372036854775808.0) {
+            return INT64_MIN;
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    inline void scalar::normalize() {
+        if (_type == falk::type::INT) {
+            auto value = truncate(_real);
+            _real = static_cast<double>(value);
+            _integer = value;
+        }
+    }
+
+    inline scalar& scalar::store(int64_t value) {
+        if (_type == falk::type::INT) {
+            _integer = value;
+        }
+        _real = static_cast<double>(value);
+        return *this;
+    }
+
+    inline void scalar::widen(falk::type t) {
+        if (_type == falk::type::INT && !fixed
+            && (t == falk::type::REAL || t == falk::type::COMPLEX)) {
+            _type = falk::type::REAL;
+            _imag = 0;
+        }
+    }
+
+    inline scalar& scalar::overflow(double value) {
+        widen(falk::type::REAL);
+        _real = value;
+        normalize();
+        return *this;
     }
 
     inline void scalar::set_error() {
@@ -9,13 +9,20 @@
 #include "scalar.hpp"
 
 namespace falk {
+    class dict;
+
     class variable {
-        using variant = aut::variant<scalar, array, matrix>;
+        using variant = aut::variant<scalar, array, matrix, dict>;
      public:
         variable(falk::type = falk::type());
 
         variable(bool);
 
+        variable(const variable&);
+        variable(variable&&) = default;
+        variable& operator=(const variable&);
+        variable& operator=(variable&&) = default;
+
         template<typename T>
         variable(const T&);
 
@@ -64,5 +71,6 @@ namespace falk {
 }
 
 #include "variable.ipp"
+#include "dict.hpp"
 
 #endif /* FALK_EV_SCALAR_HPP */
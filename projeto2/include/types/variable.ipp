@@ -52,6 +52,10 @@ falk::variable& falk::variable::op(op::callback<Type, OP, 2> op,
             op(raw, v);
             break;
         }
+        case falk::structural::type::DICT:
+            err::semantic<Error::ILLEGAL_ASSIGNMENT>(type, v.type());
+            fail = true;
+            break;
     }
 
     return *this;
@@ -101,24 +105,3 @@ template<typename T>
 falk::variable& falk::variable::assign(const T& rhs) {
     return op(op::callback<op::assignment,op::assignment::DIRECT, 2>(), rhs);
 }
-
-inline std::ostream& falk::operator<<(std::ostream& out, const variable& v) {
-    switch (v.stored_type()) {
-        case falk::structural::type::SCALAR: {
-            auto& raw = v.value<scalar>();
-            out << raw;
-            break;
-        }
-        case falk::structural::type::ARRAY: {
-            auto& raw = v.value<array>();
-            out << raw;
-            break;
-        }
-        case falk::structural::type::MATRIX: {
-            auto& raw = v.value<matrix>();
-            out << raw;
-            break;
-        }
-    }
-    return out;
-}
@@ -1,8 +1,41 @@
 
+#include <cstring>
 #include <ncurses.h>
 #include "aut/cursed/ostreambuf.hpp"
 
+cursed::ostreambuf::ostreambuf() {
+    setp(buffer, buffer + BUFFER_SIZE);
+}
+
 cursed::ostreambuf::int_type cursed::ostreambuf::overflow(int_type c) {
-    addch(c);
-    return c;
-}
\ No newline at end of file
+    drain();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize cursed::ostreambuf::xsputn(const char* s, std::streamsize n) {
+    if (n <= epptr() - pptr()) {
+        std::memcpy(pptr(), s, n);
+        pbump(n);
+    } else {
+        drain();
+        waddnstr(stdscr, s, n);
+    }
+    return n;
+}
+
+int cursed::ostreambuf::sync() {
+    drain();
+    wrefresh(stdscr);
+    return 0;
+}
+
+void cursed::ostreambuf::drain() {
+    if (pptr() > pbase()) {
+        waddnstr(stdscr, pbase(), pptr() - pbase());
+    }
+    setp(buffer, buffer + BUFFER_SIZE);
+}
@@ -1,9 +1,17 @@
 
+#include <climits>
+#include <cstdio>
 #include <ncurses.h>
 #include "aut/cursed/istreambuf.hpp"
 #include "aut/cursed/ostreambuf.hpp"
 #include "aut/cursed/terminal.hpp"
 
+namespace {
+    // key codes of the sequences around pasted text (bracketed paste)
+    constexpr int PASTE_BEGIN = KEY_MAX + 1;
+    constexpr int PASTE_END = KEY_MAX + 2;
+}
+
 cursed::terminal::terminal():
   inbuffer{*this},
   input{&inbuffer},
@@ -23,13 +31,21 @@ cursed::terminal::terminal():
     meta(stdscr, true);
     // set scrolling area (not sure about that)
     wsetscrreg(stdscr, 0, 100);
-    // refresh screen like crazy
-    immedok(stdscr, true);
+    // the screen is refreshed by getch and when the output is flushed,
+    // not on every change (see ostreambuf)
     // disable echoing chars when getch is called
     noecho();
+    // have pasted text delimited, to take it at once
+    define_key("\033[200~", PASTE_BEGIN);
+    define_key("\033[201~", PASTE_END);
+    std::fputs("\033[?2004h", stdout);
+    std::fflush(stdout);
 }
 
 cursed::terminal::~terminal() {
+    output.flush();
+    std::fputs("\033[?2004l", stdout);
+    std::fflush(stdout);
     endwin();
 }
 
@@ -42,15 +58,27 @@ std::istream& cursed::terminal::istream() {
 }
 
 std::string cursed::terminal::get_line() {
+    // shows the pending output (e.g. the prompt) before reading
+    output.flush();
     buffer_it = buffer.end();
-    current_input = "";
+    current_input = pending_input;
+    pending_input.clear();
 
     getyx(stdscr, cursor_y, cursor_x);
     o_cursor_x = cursor_x;
+    if (!current_input.empty()) {
+        waddnstr(stdscr, current_input.data(), current_input.size());
+        cursor_x += current_input.size();
+    }
 
     int ch;
     while((ch = getch()) != '\n' && ch != '\r') {
         switch(ch) {
+            case PASTE_BEGIN:
+                if (paste_pressed()) {
+                    return current_input;
+                }
+                break;
             case KEY_UP:
                 up_pressed();
                 break;
@@ -92,9 +120,8 @@ std::string cursed::terminal::get_line() {
     current_input.push_back(ch);
 
     wmove(stdscr, cursor_y, o_cursor_x);
-    for (auto& c : current_input) {
-        waddch(stdscr, c);
-    }
+    waddnstr(stdscr, current_input.data(), current_input.size());
+    wrefresh(stdscr);
     return current_input;
 }
 
@@ -186,14 +213,54 @@ void cursed::terminal::page_down_pressed() {
     wscrl(stdscr, 1);
 }
 
+bool cursed::terminal::paste_pressed() {
+    // the pasted text is read without updating the screen
+    std::string text;
+    int ch;
+    while ((ch = getch()) != PASTE_END && ch != ERR) {
+        if (ch == '\r') {
+            ch = '\n';
+        }
+        // key codes (above 255) are not characters
+        if (ch == '\n' || ch == '\t' || (ch <= UCHAR_MAX && isprint(ch))) {
+            text.push_back(ch);
+        }
+    }
+
+    current_input.insert(cursor_x - o_cursor_x, text);
+    cursor_x += text.size();
+    auto end = current_input.rfind('\n');
+    if (end == std::string::npos) {
+        wmove(stdscr, cursor_y, o_cursor_x);
+        waddnstr(stdscr, current_input.data(), current_input.size());
+        wmove(stdscr, cursor_y, cursor_x);
+        return false;
+    }
+
+    // complete lines are taken as input, the rest is kept to be edited
+    pending_input = current_input.substr(end + 1);
+    current_input.erase(end + 1);
+    size_t start = 0;
+    for (auto next = current_input.find('\n'); next != std::string::npos;
+         start = next + 1, next = current_input.find('\n', start)) {
+        if (next > start) {
+            buffer.push_back(current_input.substr(start, next - start));
+        }
+    }
+
+    wmove(stdscr, cursor_y, o_cursor_x);
+    wclrtoeol(stdscr);
+    waddnstr(stdscr, current_input.data(), current_input.size());
+    wrefresh(stdscr);
+    return true;
+}
+
 void cursed::terminal::save_character(int ch) {
     if (isprint(ch)) {
         current_input.insert(cursor_x - o_cursor_x, 1, ch);
 
         wmove(stdscr, cursor_y, o_cursor_x);
-        for (auto& c : current_input) {
-            waddch(stdscr, c);
-        }
+        waddnstr(stdscr, current_input.data(), current_input.size());
         ++cursor_x;
         wmove(stdscr, cursor_y, cursor_x);
     }
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "base/audit.hpp"
+#include "base/profiler.hpp"
+#include "types/variable.hpp"
+
+namespace {
+    using falk::audit::conversion;
+
+    constexpr size_t TOP = 20;
+
+    const char* const names[] = {
+        "coercion (array::coerce_to)",
+        "row retyping (matrix::prepare)",
+        "broadcast (scalar::to_array)",
+        "promotion (array::to_matrix)",
+        "value copy (valueof)",
+        "result copy (update_result)",
+    };
+
+    struct total {
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    // conversions may happen in the threads of parallel builtins
+    std::mutex lock;
+    std::map<std::pair<conversion, unsigned>, total> records;
+}
+
+bool falk::audit::enabled = false;
+
+void falk::audit::start() {
+    enabled = true;
+    profiler::tracking = true;
+}
+
+void falk::audit::note(conversion kind, size_t bytes) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto& t = records[{kind, profiler::line}];
+    ++t.count;
+    t.bytes += bytes;
+}
+
+void falk::audit::report(std::ostream& out) {
+    std::lock_guard<std::mutex> guard(lock);
+    total kinds[size_t(conversion::COUNT)];
+    std::vector<std::pair<std::pair<conversion, unsigned>, total>> sorted;
+    for (auto& r : records) {
+        auto& k = kinds[size_t(r.first.first)];
+        k.count += r.second.count;
+        k.bytes += r.second.bytes;
+        sorted.push_back(r);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+        return a.second.bytes > b.second.bytes;
+    });
+
+    out << std::left << std::setw(34) << "conversion" << std::right
+        << std::setw(12) << "count" << std::setw(14) << "bytes" << "\n";
+    for (size_t i = 0; i < size_t(conversion::COUNT); i++) {
+        out << std::left << std::setw(34) << names[i] << std::right
+            << std::setw(12) << kinds[i].count << std::setw(14)
+            << kinds[i].bytes << "\n";
+    }
+
+    out << "\ntop offenders\n" << std::left << std::setw(8) << "line"
+        << std::setw(34) << "conversion" << std::right << std::setw(12)
+        << "count" << std::setw(14) << "bytes" << "\n";
+    for (size_t i = 0; i < sorted.size() && i < TOP; i++) {
+        auto line = sorted[i].first.second;
+        out << std::left << std::setw(8)
+            << (line ? std::to_string(line) : std::string("-"))
+            << std::setw(34) << names[size_t(sorted[i].first.first)]
+            << std::right << std::setw(12) << sorted[i].second.count
+            << std::setw(14) << sorted[i].second.bytes << "\n";
+    }
+    out << std::flush;
+}
+
+size_t falk::audit::bytes(const variable& value) {
+    switch (value.stored_type()) {
+        case structural::type::SCALAR:
+            return sizeof(scalar);
+        case structural::type::ARRAY: {
+            auto& a = value.value<array>();
+            return a.size() * a.element_size();
+        }
+        case structural::type::MATRIX: {
+            auto& m = value.value<matrix>();
+            return m.row_count() * m.column_count() * m.element_size();
+        }
+        case structural::type::DICT: {
+            size_t result = 0;
+            value.value<dict>().for_each(
+                [&](const scalar&, const variable& entry) {
+                    result += sizeof(scalar) + bytes(entry);
+                });
+            return result;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <unordered_map>
+
+#include "base/builtins.hpp"
+#include "lib/containers.hpp"
+#include "lib/convolution.hpp"
+#include "lib/dicts.hpp"
+#include "lib/fft.hpp"
+#include "lib/functional.hpp"
+#include "lib/integration.hpp"
+#include "lib/math.hpp"
+#include "lib/random.hpp"
+#include "lib/sets.hpp"
+#include "lib/sorting.hpp"
+#include "lib/stats.hpp"
+#include "lib/workspace.hpp"
+
+namespace {
+    using builtin = falk::builtins::builtin;
+
+    const std::unordered_map<std::string, builtin> table = {
+        // containers
+        {"append", {2, 2, falk::lib::append}},
+        {"pop", {1, 1, falk::lib::pop}},
+        {"extend", {2, 2, falk::lib::extend}},
+        {"reserve", {2, 2, falk::lib::reserve}},
+        // dicts
+        {"todict", {2, 2, falk::lib::todict}},
+        {"has", {2, 2, falk::lib::has}},
+        {"get", {2, 3, falk::lib::get}},
+        {"remove", {2, 2, falk::lib::remove}},
+        {"keys", {1, 1, falk::lib::keys}},
+        {"values", {1, 1, falk::lib::values}},
+        // sets
+        {"unique", {1, 2, falk::lib::unique}},
+        {"union", {2, 3, falk::lib::unite}},
+        {"intersect", {2, 3, falk::lib::intersect}},
+        {"setdiff", {2, 3, falk::lib::setdiff}},
+        {"ismember", {2, 2, falk::lib::ismember}},
+        {"in", {2, 2, falk::lib::member}},
+        {"value_counts", {1, 2, falk::lib::value_counts}},
+        // sorting
+        {"sort", {1, 2, falk::lib::sort}},
+        {"argsort", {1, 2, falk::lib::argsort}},
+        {"sortrows", {2, 3, falk::lib::sortrows}},
+        {"topk", {2, 3, falk::lib::topk}},
+        // math
+        {"exp", {1, 1, falk::lib::exp}},
+        {"log", {1, 1, falk::lib::log}},
+        {"sin", {1, 1, falk::lib::sin}},
+        {"cos", {1, 1, falk::lib::cos}},
+        {"sqrt", {1, 1, falk::lib::sqrt}},
+        {"abs", {1, 1, falk::lib::abs}},
+        {"floor", {1, 1, falk::lib::floor}},
+        {"strict_math", {1, 1, falk::lib::strict_math}},
+        // random numbers
+        {"seed", {1, 1, falk::lib::seed}},
+        {"rand", {0, 2, falk::lib::rand}},
+        {"randn", {0, 2, falk::lib::randn}},
+        {"randint", {2, 4, falk::lib::randint}},
+        // statistics
+        {"mean", {1, 1, falk::lib::mean}},
+        {"variance", {1, 1, falk::lib::variance}},
+        {"std", {1, 1, falk::lib::stdev}},
+        {"median", {1, 1, falk::lib::median}},
+        {"quantile", {2, 2, falk::lib::quantile}},
+        {"cov", {1, 2, falk::lib::cov}},
+        {"hist", {2, 4, falk::lib::hist}},
+        // spectral transforms
+        {"fft", {1, 1, falk::lib::fft}},
+        {"ifft", {1, 1, falk::lib::ifft}},
+        {"rfft", {1, 1, falk::lib::rfft}},
+        {"fft2", {1, 1, falk::lib::fft2}},
+        {"ifft2", {1, 1, falk::lib::ifft2}},
+        // convolution
+        {"conv", {2, 3, falk::lib::conv}},
+        {"conv2", {2, 3, falk::lib::conv2}},
+        {"stencil", {2, 3, falk::lib::stencil}},
+        // integration
+        {"quad", {3, 4, falk::lib::quad}},
+        {"ode_rk45", {4, 6, falk::lib::ode_rk45}},
+        // higher-order functions
+        {"map", {2, 2, falk::lib::map}},
+        {"map_rows", {2, 2, falk::lib::map_rows}},
+        {"reduce", {3, 3, falk::lib::reduce}},
+        {"filter", {2, 2, falk::lib::filter}},
+        // workspace
+        {"whos", {0, 0, falk::lib::whos}},
+    };
+}
+
+const falk::builtins::builtin* falk::builtins::find(const std::string& id) {
+    auto it = table.find(id);
+    return it != table.end() ? &it->second : nullptr;
+}
@@ -1,5 +1,10 @@
+#include <algorithm>
+
+#include "base/audit.hpp"
 #include "base/errors.hpp"
 #include "base/evaluator.hpp"
+#include "lib/workspace.hpp"
+#include "types/integers.hpp"
 
 void falk::evaluator::get_value(symbol_mapper& mapper,
                                 const declare_variable& var) {
@@ -12,6 +17,8 @@ void falk::evaluator::get_value(symbol_mapper& mapper,
     switch (type) {
         case structural::type::SCALAR: {
             auto result = aut::pop(scalar_stack);
+            // the type is deduced, not declared
+            result.fixed_type(false);
             if (!result.error()) {
                 mapper.declare_variable(var.id, variable(result));
             }
@@ -31,6 +38,13 @@ void falk::evaluator::get_value(symbol_mapper& mapper,
             }
             break;
         }
+        case structural::type::DICT: {
+            auto result = aut::pop(dict_stack);
+            if (!result.error()) {
+                mapper.declare_variable(var.id, variable(result));
+            }
+            break;
+        }
     }
 }
 
@@ -39,8 +53,12 @@ void falk::evaluator::analyse(const declare_variable& var,
     if (!nodes[0]->empty()) {
         nodes[0]->visit(*this);
         get_value(mapper, var);
+    } else if (var.s_type == structural::type::DICT) {
+        mapper.declare_variable(var.id, variable(dict()));
     } else {
-        mapper.declare_variable(var.id, variable(var.f_type));
+        auto value = scalar(var.f_type);
+        value.fixed_type(true);
+        mapper.declare_variable(var.id, variable(value));
     }
 }
 
@@ -62,7 +80,9 @@ void falk::evaluator::analyse(var_id& vid, node_array<2>& index) {
             push(vid);
             return;
         }
-        vid.index.first = aut::pop(scalar_stack).real();
+        vid.key = aut::pop(scalar_stack);
+        vid.keyed = true;
+        vid.index.first = vid.key.integer();
     }
 
     if (!index[1]->empty()) {
@@ -74,91 +94,210 @@ void falk::evaluator::analyse(var_id& vid, node_array<2>& index) {
             push(vid);
             return;
         }
-        vid.index.second = aut::pop(scalar_stack).real();
+        vid.index.second = aut::pop(scalar_stack).integer();
     }
 
     push(vid);
 }
 
 void falk::evaluator::analyse(fun_id& fun, node_array<1>& nodes) {
+    if (mapper.type_of(fun.id) == symbol::type::UNDECLARED) {
+        if (auto builtin = builtins::find(fun.id)) {
+            call(*builtin, fun, nodes);
+            return;
+        }
+    }
+
     auto& fn = mapper.retrieve_function(fun.id);
     auto& params = fn.params();
     if (!fn.error() && params.size() == fun.number_of_params) {
         nodes[0]->visit(*this);
-        mapper.open_scope();
-        bool error = false;
-        for (int i = fun.number_of_params - 1; i >= 0; i--) {
-            auto t = aut::pop(types_stack);
-            if (params[i].s_type != t) {
-                err::semantic<Error::MISMATCHING_PARAMETER>(
-                    fun.id, params[i].vid.id, params[i].s_type, t
-                );
-                error = true;
+        enter(fn, fun.id);
+    } else if (fn.error()) {
+        push(scalar::invalid());
+    } else {
+        err::semantic<Error::MISMATCHING_PARAMETER_COUNT>(
+            fun.id, params.size(), fun.number_of_params
+        );
+        push(scalar::invalid());
+    }
+}
+
+void falk::evaluator::enter(function& fn, const std::string& id) {
+    profiler::frame call{id};
+    trace::span traced{id};
+    auto& params = fn.params();
+    mapper.open_scope();
+    bool error = false;
+    for (int i = params.size() - 1; i >= 0; i--) {
+        auto t = aut::pop(types_stack);
+        if (params[i].s_type != t) {
+            err::semantic<Error::MISMATCHING_PARAMETER>(
+                id, params[i].vid.id, params[i].s_type, t
+            );
+            error = true;
+        }
+        switch (t) {
+            case structural::type::SCALAR: {
+                auto v = aut::pop(scalar_stack);
+                v.fixed_type(false);
+                mapper.declare_variable(params[i].vid.id, variable(v));
+                break;
             }
-            switch (t) {
-                case structural::type::SCALAR: {
-                    auto v = aut::pop(scalar_stack);
-                    mapper.declare_variable(params[i].vid.id, variable(v));
-                    break;
-                }
-                case structural::type::ARRAY: {
-                    auto v = aut::pop(array_stack);
-                    auto expected_size = params[i].vid.index.first;
-                    if (expected_size != -1 && v.size() != expected_size) {
-                        err::semantic<Error::PARAMETER_ARRAY_SIZE_MISMATCH>(
-                            fun.id, params[i].vid.id, expected_size, v.size()
-                        );
-                        error = true;
-                        break;
-                    }
-                    mapper.declare_variable(params[i].vid.id, variable(v));
+            case structural::type::ARRAY: {
+                auto v = aut::pop(array_stack);
+                auto expected_size = params[i].vid.index.first;
+                if (expected_size != -1 && v.size() != expected_size) {
+                    err::semantic<Error::PARAMETER_ARRAY_SIZE_MISMATCH>(
+                        id, params[i].vid.id, expected_size, v.size()
+                    );
+                    error = true;
                     break;
                 }
-                case structural::type::MATRIX: {
-                    auto v = aut::pop(matrix_stack);
-                    auto expected_rows = params[i].vid.index.first;
-                    auto expected_columns = params[i].vid.index.second;
-                    bool row_mismatch = expected_rows != -1
-                                     && v.row_count() != expected_rows;
-                    bool column_mismatch = expected_columns != -1
-                                        && v.column_count() != expected_columns;
-                    if (row_mismatch || column_mismatch) {
-                        err::semantic<Error::PARAMETER_MATRIX_SIZE_MISMATCH>(
-                            fun.id, params[i].vid.id,
-                            expected_rows, expected_columns,
-                            v.row_count(), v.column_count()
-                        );
-                        error = true;
-                        break;
-                    }
-                    mapper.declare_variable(params[i].vid.id, variable(v));
+                mapper.declare_variable(params[i].vid.id, variable(v));
+                break;
+            }
+            case structural::type::MATRIX: {
+                auto v = aut::pop(matrix_stack);
+                auto expected_rows = params[i].vid.index.first;
+                auto expected_columns = params[i].vid.index.second;
+                bool row_mismatch = expected_rows != -1
+                                 && v.row_count() != expected_rows;
+                bool column_mismatch = expected_columns != -1
+                                    && v.column_count() != expected_columns;
+                if (row_mismatch || column_mismatch) {
+                    err::semantic<Error::PARAMETER_MATRIX_SIZE_MISMATCH>(
+                        id, params[i].vid.id,
+                        expected_rows, expected_columns,
+                        v.row_count(), v.column_count()
+                    );
+                    error = true;
                     break;
                 }
+                mapper.declare_variable(params[i].vid.id, variable(v));
+                break;
+            }
+            case structural::type::DICT: {
+                auto v = aut::pop(dict_stack);
+                mapper.declare_variable(params[i].vid.id, variable(v));
+                break;
             }
         }
+    }
 
-        if (!error) {
-            auto& code = fn.code();
-            ++function_counter;
-            code->visit(*this);
-            --function_counter;
-
-            if (!return_called) {
-                push(scalar::silent());
+    if (!error) {
+        traced.annotate([&] {
+            std::string result;
+            for (auto& param : params) {
+                auto& value = mapper.retrieve_variable(param.vid.id);
+                result += (result.empty() ? "" : ", ")
+                        + trace::field(param.vid.id, trace::shape(value));
             }
-        } else {
-            push(scalar::invalid());
+            return result;
+        });
+
+        auto& code = fn.code();
+        ++function_counter;
+        code->visit(*this);
+        --function_counter;
+
+        if (!return_called) {
+            push(scalar::silent());
         }
-        return_called = false;
-        mapper.close_scope();
-    } else if (fn.error()) {
-        push(scalar::invalid());
     } else {
+        push(scalar::invalid());
+    }
+    return_called = false;
+    mapper.close_scope();
+}
+
+falk::variable falk::evaluator::invoke(const std::string& id,
+                                       const std::vector<variable>& args) {
+    auto& fn = mapper.retrieve_function(id);
+    if (fn.error()) {
+        return variable(true);
+    }
+
+    if (fn.params().size() != args.size()) {
         err::semantic<Error::MISMATCHING_PARAMETER_COUNT>(
-            fun.id, params.size(), fun.number_of_params
+            id, fn.params().size(), args.size()
+        );
+        return variable(true);
+    }
+
+    for (auto& arg : args) {
+        push(arg);
+    }
+    enter(fn, id);
+    return pop();
+}
+
+void falk::evaluator::call(const builtins::builtin& fn, const fun_id& fun,
+                           node_array<1>& nodes) {
+    auto count = fun.number_of_params;
+    if (count < fn.min_arity || count > fn.max_arity) {
+        err::semantic<Error::MISMATCHING_PARAMETER_COUNT>(
+            fun.id, count < fn.min_arity ? fn.min_arity : fn.max_arity, count
         );
         push(scalar::invalid());
+        return;
+    }
+
+    builtins::arguments args;
+    for (size_t i = 0; i < count; i++) {
+        args.push_back(nodes[0]->subnode(i));
     }
+    profiler::frame call{fun.id};
+    fn.call(*this, args);
+}
+
+falk::variable falk::evaluator::evaluate(const node_ptr& node) {
+    node->visit(*this);
+    return pop();
+}
+
+falk::variable falk::evaluator::pop() {
+    switch (aut::pop(types_stack)) {
+        case structural::type::SCALAR:
+            return variable(aut::pop(scalar_stack));
+        case structural::type::ARRAY:
+            return variable(aut::pop(array_stack));
+        case structural::type::MATRIX:
+            return variable(aut::pop(matrix_stack));
+        case structural::type::DICT:
+            return variable(aut::pop(dict_stack));
+    }
+    return variable();
+}
+
+falk::var_id* falk::evaluator::identifier(const node_ptr& node) {
+    if (!ast::inspect<valueof>(node)) {
+        return nullptr;
+    }
+
+    auto is_empty = [](const node_ptr& n) { return !n || n->empty(); };
+    auto vid = node->subnode(0);
+    auto data = vid ? ast::inspect<var_id>(vid) : nullptr;
+    if (!data || !is_empty(vid->subnode(0)) || !is_empty(vid->subnode(1))) {
+        return nullptr;
+    }
+    return data;
+}
+
+falk::variable* falk::evaluator::reference(const node_ptr& node) {
+    auto data = identifier(node);
+    if (!data || mapper.type_of(data->id) != symbol::type::VARIABLE) {
+        return nullptr;
+    }
+    return &mapper.retrieve_variable(data->id);
+}
+
+std::string falk::evaluator::function_of(const node_ptr& node) {
+    auto data = identifier(node);
+    if (!data || mapper.type_of(data->id) != symbol::type::FUNCTION) {
+        return "";
+    }
+    return data->id;
 }
 
 void falk::evaluator::analyse(const print& p, node_array<1>& nodes) {
@@ -173,12 +312,24 @@ void falk::evaluator::analyse(const print& p, node_array<1>& nodes) {
         }
         case structural::type::ARRAY: {
             auto result = aut::pop(array_stack);
+            trace::span traced{"print", result.size(), [&] {
+                return trace::field("value", trace::shape(result));
+            }};
             if (!result.error())
                 mapper.update_result(p(result));
             break;
         }
         case structural::type::MATRIX: {
             auto result = aut::pop(matrix_stack);
+            trace::span traced{"print", result.row_count() * result.column_count(), [&] {
+                return trace::field("value", trace::shape(result));
+            }};
+            if (!result.error())
+                mapper.update_result(p(result));
+            break;
+        }
+        case structural::type::DICT: {
+            auto result = aut::pop(dict_stack);
             if (!result.error())
                 mapper.update_result(p(result));
             break;
@@ -215,40 +366,75 @@ void falk::evaluator::analyse(const valueof&, node_array<1>& nodes) {
             break;
         }
         case structural::type::ARRAY: {
-            auto value = var.value<array>();
+            const auto& value = var.value<array>();
             if (vid.index.second > -1) {
                 err::semantic<Error::TOO_MANY_INDEXES>();
-                value.set_error();
-                push(value);
+                auto copy = value;
+                copy.set_error();
+                push(copy);
                 return;
             }
 
             if (vid.index.first > -1) {
+                if (vid.proven.first) {
+                    push(value.unchecked(vid.index.first));
+                    return;
+                }
+
                 if (vid.index.first >= value.size()) {
                     err::semantic<Error::INDEX_OUT_OF_BOUNDS>(value.size(), vid.index.first);
-                    value.set_error();
-                    push(value);
+                    auto copy = value;
+                    copy.set_error();
+                    push(copy);
                     return;
                 }
-                push(value[vid.index.first]);
+                push(value.unchecked(vid.index.first));
             } else {
-                push(var.value<array>());
+                audit::record(audit::conversion::VALUE_COPY,
+                              value.size() * value.element_size());
+                push(value);
             }
             break;
         }
         case structural::type::MATRIX: {
-            auto value = var.value<matrix>();
+            const auto& value = var.value<matrix>();
             if (vid.index.first > -1 && vid.index.second > -1) {
-                push(value.at(vid.index.first, vid.index.second));
+                if (vid.proven.first && vid.proven.second) {
+                    push(value.unchecked(vid.index.first, vid.index.second));
+                } else {
+                    push(value.at(vid.index.first, vid.index.second));
+                }
             } else if (vid.index.first > -1) {
                 push(value.row(vid.index.first));
             } else if (vid.index.second > -1) {
                 push(value.column(vid.index.second));
             } else {
+                audit::record(audit::conversion::VALUE_COPY,
+                              value.row_count() * value.column_count()
+                              * value.element_size());
                 push(value);
             }
             break;
         }
+        case structural::type::DICT: {
+            auto& value = var.value<dict>();
+            if (!vid.keyed) {
+                audit::record(audit::conversion::VALUE_COPY,
+                              audit::bytes(var));
+                push(value);
+            } else if (vid.index.second > -1) {
+                err::semantic<Error::TOO_MANY_INDEXES>();
+                push(scalar::invalid());
+            } else if (auto entry = value.find(vid.key)) {
+                push(*entry);
+            } else {
+                std::ostringstream key;
+                key << vid.key;
+                err::semantic<Error::KEY_NOT_FOUND>(key.str());
+                push(scalar::invalid());
+            }
+            break;
+        }
         // default:
         // THROW A BRICK AT THE USER
         // use of undefined variable
@@ -259,8 +445,10 @@ void falk::evaluator::analyse(const valueof&, node_array<1>& nodes) {
 void falk::evaluator::analyse(const typeof&, node_array<1>& nodes) {
     nodes[0]->visit(*this);
 
-    if(aut::pop(types_stack) != structural::type::SCALAR) {
+    auto t1 = aut::pop(types_stack);
+    if (t1 != structural::type::SCALAR) {
         err::semantic<Error::NONSCALAR_TYPEOF>();
+        discard(t1);
         push(scalar::invalid());
         return;
     }
@@ -296,7 +484,21 @@ void falk::evaluator::analyse(const conditional&, node_array<3>& nodes) {
     }
 }
 
-void falk::evaluator::analyse(const loop&, node_array<2>& nodes) {
+void falk::evaluator::analyse(loop& l, node_array<2>& nodes) {
+    if (!l.analysed) {
+        l.plan = optimizer::recognize(l, nodes);
+        l.bounds = optimizer::prove(l, nodes);
+        l.analysed = true;
+    }
+
+    if (l.plan && execute(*l.plan)) {
+        return;
+    }
+
+    if (l.bounds) {
+        verify(*l.bounds);
+    }
+
     nodes[0]->visit(*this);
     auto type = aut::pop(types_stack);
     if (type == structural::type::SCALAR) {
@@ -312,14 +514,31 @@ void falk::evaluator::analyse(const loop&, node_array<2>& nodes) {
     }
 }
 
-void falk::evaluator::analyse(const for_it& fit, node_array<2>& nodes) {
-    nodes[0]->visit(*this);
-    auto vid = aut::pop(id_stack);
-    if (vid.fail) {
-        return;
+void falk::evaluator::analyse(for_it& fit, node_array<2>& nodes) {
+    if (!fit.analysed) {
+        fit.plan = optimizer::recognize(fit, nodes);
+        fit.analysed = true;
     }
 
-    auto& var = mapper.retrieve_variable(vid.id);
+    // ranges are iterated lazily, without building an array
+    range values;
+    variable* source = nullptr;
+    if (ast::inspect<make_range>(nodes[0])) {
+        auto& node = nodes[0];
+        node_array<3> bounds = {node->subnode(0), node->subnode(1),
+                                node->subnode(2)};
+        values = range_of(bounds);
+        if (values.error()) {
+            return;
+        }
+    } else {
+        nodes[0]->visit(*this);
+        auto vid = aut::pop(id_stack);
+        if (vid.fail) {
+            return;
+        }
+        source = &mapper.retrieve_variable(vid.id);
+    }
 
     auto type = mapper.type_of(fit.var_name);
     if (type == symbol::type::FUNCTION) {
@@ -330,13 +549,37 @@ void falk::evaluator::analyse(const for_it& fit, node_array<2>& nodes) {
         return;
     }
 
+    if (!source) {
+        if (fit.plan && execute(*fit.plan, values)) {
+            return;
+        }
+
+        for (size_t i = 0; i < values.size(); i++) {
+            mapper.open_scope();
+            mapper.declare_variable(fit.var_name, variable(values[i]));
+            nodes[1]->visit(*this);
+            mapper.close_scope();
+        }
+        return;
+    }
+
+    auto& var = *source;
     switch (var.stored_type()) {
         case structural::type::SCALAR: {
             err::semantic<Error::FOR_SCALAR_TARGET>();
-            break;
+            return;
         }
+        default:;
+    }
+
+    if (fit.plan && execute(*fit.plan, var)) {
+        return;
+    }
+
+    switch (var.stored_type()) {
         case structural::type::ARRAY: {
-            for (auto& element : var.value<array>()) {
+            const auto& elements = var.value<array>();
+            for (auto element : elements) {
                 mapper.open_scope();
                 mapper.declare_variable(fit.var_name, variable(element));
                 nodes[1]->visit(*this);
@@ -355,9 +598,339 @@ void falk::evaluator::analyse(const for_it& fit, node_array<2>& nodes) {
             }
             break;
         }
+        case structural::type::DICT: {
+            // iterates over a copy of the keys, so the body may change
+            // the dict
+            const auto keys = var.value<dict>().keys();
+            for (auto key : keys) {
+                mapper.open_scope();
+                mapper.declare_variable(fit.var_name, variable(key));
+                nodes[1]->visit(*this);
+                mapper.close_scope();
+            }
+            break;
+        }
+        default:;
+    }
+}
+
+bool falk::evaluator::execute(const kernel& k) {
+    auto is_variable = [&](const std::string& id) {
+        return mapper.type_of(id) == symbol::type::VARIABLE;
+    };
+
+    if (!is_variable(k.counter) || !is_variable(k.target)) {
+        return false;
+    }
+
+    auto& counter = mapper.retrieve_variable(k.counter);
+    auto& target = mapper.retrieve_variable(k.target);
+    auto shape = target.stored_type();
+    if (counter.stored_type() != structural::type::SCALAR
+        || shape == structural::type::SCALAR
+        || shape == structural::type::DICT) {
+        return false;
+    }
+
+    // Operands are bound once: the body has no declarations, so names
+    // keep referring to the same variables during the whole loop.
+    struct binding {
+        const scalar* value = nullptr;
+        const array* elements = nullptr;
+        const matrix* rows = nullptr;
+    };
+
+    size_t bound = shape == structural::type::ARRAY
+                 ? target.value<array>().size()
+                 : target.value<matrix>().row_count();
+    auto bind = [&](const kernel::operand& operand, binding& result) {
+        if (operand.id.empty()) {
+            result.value = &operand.literal;
+            return true;
+        }
+
+        if (!is_variable(operand.id)) {
+            return false;
+        }
+
+        auto& var = mapper.retrieve_variable(operand.id);
+        if (!operand.indexed) {
+            if (var.stored_type() != structural::type::SCALAR) {
+                return false;
+            }
+            result.value = &var.value<scalar>();
+        } else if (var.stored_type() != shape) {
+            return false;
+        } else if (shape == structural::type::ARRAY) {
+            result.elements = &var.value<array>();
+            bound = std::min(bound, result.elements->size());
+        } else {
+            result.rows = &var.value<matrix>();
+            if (result.rows->column_count()
+                != target.value<matrix>().column_count()) {
+                return false;
+            }
+            bound = std::min(bound, result.rows->row_count());
+        }
+        return true;
+    };
+
+    binding limit, lhs, rhs;
+    if (!bind(k.limit, limit) || !bind(k.lhs, lhs)
+        || (k.binary && !bind(k.rhs, rhs))) {
+        return false;
+    }
+
+    // Iteration space, computed with the same operations as the
+    // interpreted condition, index conversion and increment. Anything
+    // that would fall out of bounds is left to the interpreter, so
+    // errors are reported exactly as before.
+    std::vector<size_t> indexes;
+    auto position = counter.value<scalar>();
+    while (make_comparison(k.condition, position, *limit.value).boolean()) {
+        int64_t index = position.real();
+        if (index < 0 || index >= static_cast<int64_t>(bound)) {
+            return false;
+        }
+        indexes.push_back(index);
+        position += k.step;
+    }
+
+    auto width = shape == structural::type::ARRAY
+               ? 1 : target.value<matrix>().column_count();
+    trace::span traced{"map", indexes.size() * width, [&] {
+        return trace::field("target", trace::shape(target));
+    }};
+
+    if (shape == structural::type::ARRAY) {
+        auto& values = target.value<array>();
+        auto element = [](const binding& b, size_t i) {
+            return b.elements ? b.elements->unchecked(i) : *b.value;
+        };
+        auto assign = [&](size_t i, const scalar& value) {
+            auto result = values.unchecked(i);
+            result.assign(value);
+            values.set(i, result);
+        };
+
+        if (k.binary) {
+            with_callback(k.operation, [&](auto op) {
+                for (auto i : indexes) {
+                    assign(i, op(element(lhs, i), element(rhs, i)));
+                }
+            });
+        } else {
+            for (auto i : indexes) {
+                assign(i, element(lhs, i));
+            }
+        }
+    } else {
+        auto& values = target.value<matrix>();
+        auto with_row = [](const binding& b, size_t i, auto&& f) {
+            if (b.rows) {
+                f(b.rows->row(i));
+            } else {
+                f(*b.value);
+            }
+        };
+
+        for (auto i : indexes) {
+            auto data = values.row(i);
+            if (k.binary) {
+                with_callback(k.operation, [&](auto op) {
+                    with_row(lhs, i, [&](const auto& l) {
+                        with_row(rhs, i, [&](const auto& r) {
+                            data.assign(op(l, r));
+                        });
+                    });
+                });
+            } else {
+                with_row(lhs, i, [&](const auto& l) { data.assign(l); });
+            }
+            values.assign_row(i, data);
+        }
+    }
+
+    counter.value<scalar>() = position;
+    return true;
+}
+
+void falk::evaluator::verify(const proof& p) {
+    auto scalar_of = [&](const std::string& id, scalar& result) {
+        if (mapper.type_of(id) != symbol::type::VARIABLE) {
+            return false;
+        }
+        auto& var = mapper.retrieve_variable(id);
+        if (var.stored_type() != structural::type::SCALAR) {
+            return false;
+        }
+        result = var.value<scalar>();
+        return true;
+    };
+
+    scalar counter, limit = p.limit.literal;
+    bool valid = scalar_of(p.counter, counter)
+              && (p.limit.id.empty() || scalar_of(p.limit.id, limit))
+              && counter.real() >= 0 && counter.imag() == 0
+              && limit.imag() == 0;
+
+    for (auto& access : p.accesses) {
+        bool& proven = access.slot == 0 ? access.vid->proven.first
+                                        : access.vid->proven.second;
+        proven = false;
+        if (!valid
+            || mapper.type_of(access.vid->id) != symbol::type::VARIABLE) {
+            continue;
+        }
+
+        auto& var = mapper.retrieve_variable(access.vid->id);
+        double size;
+        switch (var.stored_type()) {
+            case structural::type::ARRAY:
+                if (access.slot != 0) {
+                    continue;
+                }
+                size = var.value<array>().size();
+                break;
+            case structural::type::MATRIX: {
+                auto& m = var.value<matrix>();
+                size = access.slot == 0 ? m.row_count() : m.column_count();
+                break;
+            }
+            default:
+                continue;
+        }
+
+        proven = p.condition == op::comparison::LT ? limit.real() <= size
+                                                   : limit.real() < size;
     }
 }
 
+bool falk::evaluator::execute(const kernel& k, variable& source) {
+    if (mapper.type_of(k.target) != symbol::type::VARIABLE) {
+        return false;
+    }
+
+    auto& target = mapper.retrieve_variable(k.target);
+    trace::span traced{"reduction", trace::elements(source), [&] {
+        return trace::field("source", trace::shape(source));
+    }};
+
+    // as with ranges, integer sums are exact in any order, so a dense
+    // array is added at once unless its total does not fit an integer
+    int64_t total;
+    bool exact = source.stored_type() == structural::type::ARRAY
+              && target.stored_type() == structural::type::SCALAR
+              && target.value<scalar>().inner_type() == falk::type::INT;
+    if (exact) {
+        auto& values = static_cast<const variable&>(source).value<array>();
+        exact = values.dense()
+             && integers::sum(values.integers(), values.size(), total);
+    }
+    if (exact && k.accumulation == op::assignment::ADD) {
+        target += scalar(total);
+        return true;
+    } else if (exact && k.accumulation == op::assignment::SUB) {
+        target -= scalar(total);
+        return true;
+    }
+
+    with_callback(k.accumulation, [&](auto op) {
+        if (source.stored_type() == structural::type::ARRAY) {
+            const auto& values = source.value<array>();
+            for (auto element : values) {
+                op(target, element);
+            }
+        } else if (source.stored_type() == structural::type::DICT) {
+            const auto keys = source.value<dict>().keys();
+            for (auto key : keys) {
+                op(target, key);
+            }
+        } else {
+            auto& rows = source.value<matrix>();
+            for (size_t i = 0; i < rows.row_count(); i++) {
+                op(target, rows.row(i));
+            }
+        }
+    });
+    return true;
+}
+
+bool falk::evaluator::execute(const kernel& k, const range& values) {
+    if (mapper.type_of(k.target) != symbol::type::VARIABLE) {
+        return false;
+    }
+
+    auto& target = mapper.retrieve_variable(k.target);
+    trace::span traced{"reduction", values.size(), [&] {
+        auto size = std::to_string(values.size());
+        return trace::field("source", "range[" + size + "]");
+    }};
+
+    // integer sums are exact in any order (and become reals when too
+    // large), so the whole range can be added at once
+    bool exact = target.stored_type() == structural::type::SCALAR
+              && target.value<scalar>().inner_type() == falk::type::INT
+              && values.inner_type() == falk::type::INT;
+    if (exact && k.accumulation == op::assignment::ADD) {
+        target += values.sum();
+        return true;
+    } else if (exact && k.accumulation == op::assignment::SUB) {
+        target -= values.sum();
+        return true;
+    }
+
+    with_callback(k.accumulation, [&](auto op) {
+        for (size_t i = 0; i < values.size(); i++) {
+            op(target, values[i]);
+        }
+    });
+    return true;
+}
+
+falk::range falk::evaluator::range_of(node_array<3>& nodes) {
+    scalar bounds[3];
+    bool valid = true;
+    for (size_t i = 0; i < 3; i++) {
+        nodes[i]->visit(*this);
+        switch (aut::pop(types_stack)) {
+            case structural::type::SCALAR:
+                bounds[i] = aut::pop(scalar_stack);
+                valid = valid && !bounds[i].error();
+                break;
+            case structural::type::ARRAY:
+                aut::pop(array_stack);
+                valid = false;
+                err::semantic<Error::NONSCALAR_RANGE>();
+                break;
+            case structural::type::MATRIX:
+                aut::pop(matrix_stack);
+                valid = false;
+                err::semantic<Error::NONSCALAR_RANGE>();
+                break;
+            case structural::type::DICT:
+                aut::pop(dict_stack);
+                valid = false;
+                err::semantic<Error::NONSCALAR_RANGE>();
+                break;
+        }
+    }
+
+    if (!valid) {
+        return range(true);
+    }
+    return {bounds[0], bounds[1], bounds[2]};
+}
+
+void falk::evaluator::analyse(const make_range&, node_array<3>& nodes) {
+    auto values = range_of(nodes);
+    if (values.error()) {
+        push(array(true));
+        return;
+    }
+    push(values.to_array());
+}
+
 void falk::evaluator::analyse(const ret&, node_array<1>& nodes) {
     if (function_counter > 0) {
         nodes[0]->visit(*this);
@@ -371,8 +944,19 @@ void falk::evaluator::analyse(const undef& container) {
     mapper.undefine_function(container.id);
 }
 
+void falk::evaluator::analyse(const whos&) {
+    lib::report(std::cout, mapper);
+}
+
+const falk::symbol_mapper& falk::evaluator::symbols() const {
+    return mapper;
+}
+
 void falk::evaluator::process(node_ptr v) {
     if (!v->empty()) {
+        trace::span traced{"command", [&] {
+            return trace::field("line", std::to_string(v->where().line));
+        }};
         v->visit(*this);
     }
 }
@@ -387,6 +971,9 @@ void falk::evaluator::analyse(const create_structure&,
     array arr;
     matrix m;
     auto result_type = structural::type::ARRAY;
+    // values come out of the stacks in reverse order
+    std::vector<scalar> elements;
+    std::vector<array> rows;
 
     for (auto i = 0; i < size; i++) {
         auto type = aut::pop(types_stack);
@@ -398,8 +985,7 @@ void falk::evaluator::analyse(const create_structure&,
                     push(m);
                     return;
                 }
-                auto scalar = aut::pop(scalar_stack);
-                arr.push_front(scalar);
+                elements.push_back(aut::pop(scalar_stack));
                 result_type = structural::type::ARRAY;
                 break;
             }
@@ -410,8 +996,7 @@ void falk::evaluator::analyse(const create_structure&,
                     push(arr);
                     return;
                 }
-                auto a = aut::pop(array_stack);
-                m.push_front(a);
+                rows.push_back(aut::pop(array_stack));
                 result_type = structural::type::MATRIX;
                 break;
             }
@@ -420,12 +1005,26 @@ void falk::evaluator::analyse(const create_structure&,
                 m.set_error();
                 push(m);
                 return;
+            case structural::type::DICT:
+                err::semantic<Error::ILLEGAL_OPERATION>("dictionary as element");
+                aut::pop(dict_stack);
+                arr.set_error();
+                push(arr);
+                return;
         }
     }
 
     if (result_type == structural::type::MATRIX) {
+        m.reserve(rows.size(), rows.empty() ? 0 : rows.back().size());
+        for (auto row = rows.rbegin(); row != rows.rend(); ++row) {
+            m.push_back(*row);
+        }
         push(m);
     } else {
+        arr.reserve(elements.size());
+        for (auto e = elements.rbegin(); e != elements.rend(); ++e) {
+            arr.push_back(*e);
+        }
         push(arr);
     }
 }
@@ -0,0 +1,348 @@
+#include <algorithm>
+
+#include "base/evaluator.hpp"
+#include "base/optimizer.hpp"
+
+namespace {
+    using node_ptr = falk::optimizer::node_ptr;
+
+    template<typename T>
+    T* as(const node_ptr& node) {
+        return node ? ast::inspect<T>(node) : nullptr;
+    }
+
+    bool is_empty(const node_ptr& node) {
+        return !node || node->empty();
+    }
+
+    // Non-empty commands of a block.
+    std::vector<node_ptr> commands_of(const node_ptr& node) {
+        std::vector<node_ptr> commands;
+        for (size_t i = 0; i < node->size(); i++) {
+            auto command = node->subnode(i);
+            if (!is_empty(command)) {
+                commands.push_back(command);
+            }
+        }
+        return commands;
+    }
+
+    // Matches 'id'.
+    bool plain_id(const node_ptr& node, std::string& id) {
+        auto vid = as<falk::var_id>(node);
+        if (!vid || !is_empty(node->subnode(0))
+                 || !is_empty(node->subnode(1))) {
+            return false;
+        }
+        id = vid->id;
+        return true;
+    }
+
+    // Matches the value of 'id'.
+    bool plain_value(const node_ptr& node, std::string& id) {
+        return as<falk::valueof>(node) && plain_id(node->subnode(0), id);
+    }
+
+    // Matches 'id[counter]'.
+    bool indexed_id(const node_ptr& node, const std::string& counter,
+                    std::string& id) {
+        auto vid = as<falk::var_id>(node);
+        std::string index;
+        if (!vid || !plain_value(node->subnode(0), index)
+                 || index != counter || !is_empty(node->subnode(1))) {
+            return false;
+        }
+        id = vid->id;
+        return true;
+    }
+
+    bool operand_of(const node_ptr& node, const std::string& counter,
+                    falk::kernel::operand& result) {
+        if (auto literal = as<falk::scalar>(node)) {
+            result.literal = *literal;
+            return true;
+        }
+
+        if (!as<falk::valueof>(node)) {
+            return false;
+        }
+
+        auto vid = node->subnode(0);
+        if (plain_id(vid, result.id)) {
+            return true;
+        }
+        result.indexed = true;
+        return indexed_id(vid, counter, result.id);
+    }
+
+    template<typename Type, Type OP>
+    bool matches(const node_ptr& node) {
+        return as<falk::op::callback<Type, OP, 2>>(node) != nullptr;
+    }
+
+    bool arithmetic_of(const node_ptr& node, falk::op::arithmetic& result) {
+        using A = falk::op::arithmetic;
+        if (matches<A, A::ADD>(node)) {
+            result = A::ADD;
+        } else if (matches<A, A::SUB>(node)) {
+            result = A::SUB;
+        } else if (matches<A, A::MULT>(node)) {
+            result = A::MULT;
+        } else if (matches<A, A::DIV>(node)) {
+            result = A::DIV;
+        } else if (matches<A, A::POW>(node)) {
+            result = A::POW;
+        } else if (matches<A, A::MOD>(node)) {
+            result = A::MOD;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool assignment_of(const node_ptr& node, falk::op::assignment& result) {
+        using A = falk::op::assignment;
+        if (matches<A, A::DIRECT>(node)) {
+            result = A::DIRECT;
+        } else if (matches<A, A::ADD>(node)) {
+            result = A::ADD;
+        } else if (matches<A, A::SUB>(node)) {
+            result = A::SUB;
+        } else if (matches<A, A::MULT>(node)) {
+            result = A::MULT;
+        } else if (matches<A, A::DIV>(node)) {
+            result = A::DIV;
+        } else if (matches<A, A::POW>(node)) {
+            result = A::POW;
+        } else if (matches<A, A::MOD>(node)) {
+            result = A::MOD;
+        } else if (matches<A, A::AND>(node)) {
+            result = A::AND;
+        } else if (matches<A, A::OR>(node)) {
+            result = A::OR;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool comparison_of(const node_ptr& node, falk::op::comparison& result) {
+        using C = falk::op::comparison;
+        if (matches<C, C::LT>(node)) {
+            result = C::LT;
+        } else if (matches<C, C::LE>(node)) {
+            result = C::LE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Matches 'counter < limit' (or <=), where limit is a literal or a
+    // variable.
+    bool bounded(const node_ptr& condition, std::string& counter,
+                 falk::op::comparison& comparison,
+                 falk::kernel::operand& limit) {
+        return comparison_of(condition, comparison)
+            && plain_value(condition->subnode(0), counter)
+            && operand_of(condition->subnode(1), "", limit);
+    }
+
+    // Matches 'counter += k', k > 0.
+    bool is_increment(const node_ptr& node, const std::string& counter,
+                      falk::scalar* step = nullptr) {
+        std::string id;
+        if (!matches<falk::op::assignment, falk::op::assignment::ADD>(node)
+            || !plain_id(node->subnode(0), id) || id != counter) {
+            return false;
+        }
+
+        auto literal = as<falk::scalar>(node->subnode(1));
+        if (!literal || literal->real() <= 0 || literal->imag() != 0) {
+            return false;
+        }
+
+        if (step) {
+            *step = *literal;
+        }
+        return true;
+    }
+
+    // Visits all nodes of a subtree.
+    template<typename F>
+    void walk(const node_ptr& node, F&& f) {
+        if (is_empty(node)) {
+            return;
+        }
+
+        f(node);
+        for (size_t i = 0; i < node->size(); i++) {
+            walk(node->subnode(i), f);
+        }
+    }
+}
+
+std::shared_ptr<falk::kernel>
+falk::optimizer::recognize(const loop&, std::array<node_ptr, 2>& nodes) {
+    auto result = std::make_shared<kernel>();
+    auto& k = *result;
+    k.type = kernel::kind::MAP;
+
+    // condition: counter < limit (or <=), with a loop-invariant limit
+    if (!bounded(nodes[0], k.counter, k.condition, k.limit)) {
+        return nullptr;
+    }
+
+    if (!as<scoped>(nodes[1]) || !as<block>(nodes[1]->subnode(0))) {
+        return nullptr;
+    }
+
+    auto commands = commands_of(nodes[1]->subnode(0));
+    if (commands.size() != 2) {
+        return nullptr;
+    }
+
+    // increment: counter += step, with a positive literal step
+    if (!is_increment(commands[1], k.counter, &k.step)) {
+        return nullptr;
+    }
+
+    // element-wise statement: target[counter] = lhs (op rhs)
+    auto& statement = commands[0];
+    if (!matches<op::assignment, op::assignment::DIRECT>(statement)
+        || !indexed_id(statement->subnode(0), k.counter, k.target)) {
+        return nullptr;
+    }
+
+    auto value = statement->subnode(1);
+    if (arithmetic_of(value, k.operation)) {
+        k.binary = true;
+        if (!operand_of(value->subnode(0), k.counter, k.lhs)
+            || !operand_of(value->subnode(1), k.counter, k.rhs)) {
+            return nullptr;
+        }
+    } else if (!operand_of(value, k.counter, k.lhs)) {
+        return nullptr;
+    }
+
+    // the counter may only change through the increment and is not
+    // allowed as a value
+    if (k.target == k.counter || k.limit.id == k.counter
+        || k.lhs.id == k.counter || k.rhs.id == k.counter
+        || k.limit.id == k.target) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+std::shared_ptr<falk::proof>
+falk::optimizer::prove(const loop&, std::array<node_ptr, 2>& nodes) {
+    auto result = std::make_shared<proof>();
+    auto& p = *result;
+
+    if (!bounded(nodes[0], p.counter, p.condition, p.limit)
+        || !as<scoped>(nodes[1]) || !as<block>(nodes[1]->subnode(0))) {
+        return nullptr;
+    }
+
+    auto commands = commands_of(nodes[1]->subnode(0));
+    auto is_top_increment = [&](const node_ptr& node) {
+        return is_increment(node, p.counter)
+            && std::find(commands.begin(), commands.end(), node)
+               != commands.end();
+    };
+
+    // names that the body may rebind or resize
+    std::vector<std::string> unstable;
+    bool safe = true;
+    walk(nodes[1], [&](const node_ptr& node) {
+        op::assignment assignment;
+        std::string id;
+        if (as<fun_id>(node)) {
+            safe = false;
+        } else if (auto decl = as<declare_variable>(node)) {
+            unstable.push_back(decl->id);
+        } else if (auto fit = as<for_it>(node)) {
+            unstable.push_back(fit->var_name);
+        } else if (assignment_of(node, assignment)) {
+            auto vid = as<var_id>(node->subnode(0));
+            if (vid && vid->id == p.counter && !is_top_increment(node)) {
+                safe = false;
+            } else if (plain_id(node->subnode(0), id)) {
+                unstable.push_back(id);
+            }
+        }
+    });
+
+    auto is_unstable = [&](const std::string& id) {
+        return std::find(unstable.begin(), unstable.end(), id)
+               != unstable.end();
+    };
+
+    if (!safe || is_unstable(p.counter) || is_unstable(p.limit.id)) {
+        return nullptr;
+    }
+
+    // accesses indexed by the counter, before its first increment
+    for (auto& command : commands) {
+        if (is_top_increment(command)) {
+            break;
+        }
+
+        walk(command, [&](const node_ptr& node) {
+            auto vid = as<var_id>(node);
+            if (!vid || is_unstable(vid->id)) {
+                return;
+            }
+
+            for (size_t slot = 0; slot < 2; slot++) {
+                std::string index;
+                if (plain_value(node->subnode(slot), index)
+                    && index == p.counter) {
+                    p.accesses.push_back({vid, slot});
+                }
+            }
+        });
+    }
+
+    if (p.accesses.empty()) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+std::shared_ptr<falk::kernel>
+falk::optimizer::recognize(const for_it& fit, std::array<node_ptr, 2>& nodes) {
+    auto result = std::make_shared<kernel>();
+    auto& k = *result;
+    k.type = kernel::kind::REDUCTION;
+    k.element = fit.var_name;
+
+    // the source is a variable or a range
+    if ((!as<make_range>(nodes[0]) && !plain_id(nodes[0], k.source))
+        || !as<block>(nodes[1])) {
+        return nullptr;
+    }
+
+    auto commands = commands_of(nodes[1]);
+    if (commands.size() != 1) {
+        return nullptr;
+    }
+
+    // target op= element
+    auto& statement = commands[0];
+    std::string id;
+    if (!assignment_of(statement, k.accumulation)
+        || !plain_id(statement->subnode(0), k.target)
+        || !plain_value(statement->subnode(1), id) || id != k.element) {
+        return nullptr;
+    }
+
+    if (k.target == k.element || k.target == k.source) {
+        return nullptr;
+    }
+
+    return result;
+}
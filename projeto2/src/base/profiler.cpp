@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <signal.h>
+#include <sys/time.h>
+#include <unordered_map>
+#include <vector>
+
+#include "base/profiler.hpp"
+
+namespace {
+    constexpr size_t MAX_DEPTH = 32;
+    constexpr size_t MAX_SAMPLES = 1 << 18;
+    constexpr long INTERVAL_US = 1000;
+
+    struct sample {
+        unsigned line;
+        unsigned depth;
+        unsigned frames[MAX_DEPTH];
+    };
+
+    // written by the signal handler
+    std::vector<sample> samples;
+    std::atomic<size_t> taken{0};
+
+    // function calls being evaluated; calls deeper than MAX_DEPTH are
+    // counted but not kept
+    unsigned stack[MAX_DEPTH];
+    volatile unsigned depth = 0;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, unsigned> ids;
+
+    void handler(int) {
+        auto index = taken.fetch_add(1, std::memory_order_relaxed);
+        if (index >= samples.size()) {
+            return;
+        }
+        auto& s = samples[index];
+        s.line = falk::profiler::line;
+        unsigned current = depth;
+        s.depth = std::min<unsigned>(current, MAX_DEPTH);
+        std::copy(stack, stack + s.depth, s.frames);
+    }
+
+    void timer(long interval) {
+        itimerval value{{0, interval}, {0, interval}};
+        setitimer(ITIMER_PROF, &value, nullptr);
+    }
+
+    // samples under a sequence of calls
+    struct call {
+        size_t total = 0;
+        std::map<unsigned, call> callees;
+    };
+
+    void print(std::ostream& out, const call& node, unsigned id,
+               size_t all, size_t indent) {
+        out << std::setw(9) << node.total << std::setw(8)
+            << 100.0 * node.total / all << "%  " << std::string(indent, ' ')
+            << names[id] << "\n";
+
+        std::vector<std::pair<unsigned, const call*>> sorted;
+        for (auto& callee : node.callees) {
+            // calls under 0.5% of the samples are left out
+            if (callee.second.total * 200 >= all) {
+                sorted.emplace_back(callee.first, &callee.second);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+            return a.second->total > b.second->total;
+        });
+        for (auto& callee : sorted) {
+            print(out, *callee.second, callee.first, all, indent + 2);
+        }
+    }
+}
+
+bool falk::profiler::enabled = false;
+bool falk::profiler::tracking = false;
+volatile unsigned falk::profiler::line = 0;
+
+unsigned falk::profiler::intern(const std::string& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    names.push_back(name);
+    return ids[name] = names.size() - 1;
+}
+
+void falk::profiler::push(unsigned id) {
+    if (depth < MAX_DEPTH) {
+        stack[depth] = id;
+    }
+    // the frame must be written before the sampler can see it
+    std::atomic_signal_fence(std::memory_order_release);
+    depth = depth + 1;
+}
+
+void falk::profiler::pop() {
+    depth = depth - 1;
+}
+
+void falk::profiler::start() {
+    enabled = true;
+    tracking = true;
+    samples.resize(MAX_SAMPLES);
+    intern("<script>");
+
+    struct sigaction action = {};
+    action.sa_handler = handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+    timer(INTERVAL_US);
+}
+
+void falk::profiler::stop() {
+    timer(0);
+    signal(SIGPROF, SIG_IGN);
+}
+
+void falk::profiler::report(std::ostream& out) {
+    auto count = std::min(taken.load(), samples.size());
+    out << "profile: " << count << " samples, one per "
+        << INTERVAL_US / 1000.0 << " ms of CPU time\n";
+    if (count == 0) {
+        return;
+    }
+
+    std::map<unsigned, size_t> lines;
+    std::vector<size_t> self(names.size()), total(names.size());
+    call root;
+    for (size_t i = 0; i < count; i++) {
+        auto& s = samples[i];
+        ++lines[s.line];
+
+        // frame 0 (the script) is implicit
+        std::vector<bool> seen(names.size());
+        auto node = &root;
+        node->total++;
+        for (unsigned d = 0; d < s.depth; d++) {
+            auto id = s.frames[d];
+            if (!seen[id]) {
+                ++total[id];
+                seen[id] = true;
+            }
+            node = &node->callees[id];
+            node->total++;
+        }
+        ++self[s.depth ? s.frames[s.depth - 1] : 0];
+    }
+    total[0] = count;
+
+    out << std::fixed << std::setprecision(1);
+    out << "\nhot lines\n" << std::setw(9) << "samples" << std::setw(9)
+        << "%" << "  line\n";
+    std::vector<std::pair<unsigned, size_t>> hot(lines.begin(), lines.end());
+    std::sort(hot.begin(), hot.end(), [](auto& a, auto& b) {
+        return a.second > b.second;
+    });
+    for (size_t i = 0; i < hot.size() && i < 20; i++) {
+        out << std::setw(9) << hot[i].second << std::setw(8)
+            << 100.0 * hot[i].second / count << "%  ";
+        if (hot[i].first) {
+            out << hot[i].first << "\n";
+        } else {
+            out << "(outside the script)\n";
+        }
+    }
+
+    out << "\nhot functions\n" << std::setw(9) << "self" << std::setw(9)
+        << "%" << std::setw(9) << "total" << std::setw(9) << "%"
+        << "  function\n";
+    std::vector<unsigned> order;
+    for (unsigned id = 0; id < names.size(); id++) {
+        if (total[id]) {
+            order.push_back(id);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+        return self[a] > self[b];
+    });
+    for (auto id : order) {
+        out << std::setw(9) << self[id] << std::setw(8)
+            << 100.0 * self[id] / count << "%" << std::setw(9) << total[id]
+            << std::setw(8) << 100.0 * total[id] / count << "%  "
+            << names[id] << "\n";
+    }
+
+    out << "\ncall tree\n" << std::setw(9) << "total" << std::setw(9)
+        << "%" << "  function\n";
+    print(out, root, 0, count, 0);
+    out << std::defaultfloat << std::flush;
+}
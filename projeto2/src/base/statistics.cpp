@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <deque>
+#include <iomanip>
+#include <vector>
+
+#include "base/statistics.hpp"
+
+namespace {
+    std::deque<falk::stats::node_kind> kinds;
+    falk::stats::measurement* current = nullptr;
+
+    uint64_t now() {
+        using namespace std::chrono;
+        auto time = steady_clock::now().time_since_epoch();
+        return duration_cast<nanoseconds>(time).count();
+    }
+
+    const char* const arithmetic[] = {"+", "-", "/", "*", "**", "%"};
+    const char* const comparison[] = {"<", ">", "<=", ">=", "==", "!="};
+    const char* const logic[] = {"&", "|", "!"};
+    const char* const assignment[] = {
+        "=", "+=", "-=", "/=", "*=", "**=", "%=", "&=", "|="
+    };
+}
+
+bool falk::stats::enabled = false;
+std::atomic<uint64_t> falk::stats::events[size_t(event::COUNT)];
+std::atomic<uint64_t> falk::stats::allocated[4];
+
+falk::stats::node_kind& falk::stats::record(const std::string& name) {
+    kinds.push_back({name});
+    return kinds.back();
+}
+
+std::string falk::stats::demangle(const char* name) {
+    int status = 0;
+    auto readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = status == 0 ? readable : name;
+    std::free(readable);
+
+    std::string prefix = "falk::";
+    for (size_t at; (at = result.find(prefix)) != std::string::npos;) {
+        result.erase(at, prefix.size());
+    }
+    return result;
+}
+
+std::string falk::stats::symbol(const std::type_info& type, int op,
+                                size_t arity) {
+    std::string result = "operator ";
+    if (type == typeid(op::arithmetic)) {
+        result += arithmetic[op];
+    } else if (type == typeid(op::comparison)) {
+        result += comparison[op];
+    } else if (type == typeid(op::logic)) {
+        result += logic[op];
+    } else {
+        result += assignment[op];
+    }
+    return arity == 1 ? result + " (unary)" : result;
+}
+
+void falk::stats::measurement::start() {
+    outer = current;
+    current = this;
+    started = now();
+}
+
+void falk::stats::measurement::stop() {
+    auto elapsed = now() - started;
+    current = outer;
+    if (outer) {
+        outer->inner_ns += elapsed;
+    }
+    ++target->count;
+    target->total_ns += elapsed;
+    target->self_ns += elapsed - std::min(elapsed, inner_ns);
+}
+
+void falk::stats::report(std::ostream& out) {
+    std::vector<const node_kind*> sorted;
+    for (auto& k : kinds) {
+        sorted.push_back(&k);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const node_kind* a, const node_kind* b) {
+                  return a->self_ns > b->self_ns;
+              });
+
+    auto ms = [](uint64_t ns) { return ns / 1e6; };
+    out << std::left << std::setw(40) << "node" << std::right
+        << std::setw(12) << "count" << std::setw(12) << "total ms"
+        << std::setw(12) << "self ms" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (auto k : sorted) {
+        out << std::left << std::setw(40) << k->name << std::right
+            << std::setw(12) << k->count << std::setw(12) << ms(k->total_ns)
+            << std::setw(12) << ms(k->self_ns) << "\n";
+    }
+    out << std::defaultfloat << "\n";
+
+    auto get = [](event e) { return events[size_t(e)].load(); };
+    auto bytes = [](structural::type t) { return allocated[size_t(t)].load(); };
+    out << "deep copies:    " << get(event::ARRAY_COPY) << " arrays, "
+        << get(event::MATRIX_COPY) << " matrices\n"
+        << "scopes:         " << get(event::SCOPE_OPEN) << " opened, "
+        << get(event::SCOPE_CLOSE) << " closed\n"
+        << "symbol lookups: " << get(event::LOOKUP) << "\n"
+        << "allocated:      " << bytes(structural::type::ARRAY)
+        << " bytes in arrays, " << bytes(structural::type::MATRIX)
+        << " in matrices, " << bytes(structural::type::DICT)
+        << " in dicts" << std::endl;
+}
@@ -1,4 +1,6 @@
 
+#include "base/audit.hpp"
+#include "base/statistics.hpp"
 #include "base/symbol_mapper.hpp"
 
 namespace {
@@ -14,6 +16,7 @@ falk::symbol_mapper::symbol_mapper() {
 }
 
 void falk::symbol_mapper::update_result(variable var) {
+    audit::record(audit::conversion::RESULT_COPY, audit::bytes(var));
     auto& scope = scopes.back();
     scope.variables["res"] = std::move(var);
 }
@@ -86,14 +89,17 @@ falk::symbol_mapper::retrieve_variable(const std::string& id) {
 }
 
 void falk::symbol_mapper::open_scope() {
+    stats::count(stats::event::SCOPE_OPEN);
     scopes.emplace_front();
 }
 
 void falk::symbol_mapper::close_scope() {
+    stats::count(stats::event::SCOPE_CLOSE);
     scopes.pop_front();
 }
 
 bool falk::symbol_mapper::is_declared(const std::string& id) const {
+    stats::count(stats::event::LOOKUP);
     for (auto& scope : scopes) {
         if (scope.symbol_table.count(id)) {
             return true;
@@ -103,6 +109,7 @@ bool falk::symbol_mapper::is_declared(const std::string& id) const {
 }
 
 scope& falk::symbol_mapper::scope_of(const std::string& id) {
+    stats::count(stats::event::LOOKUP);
     for (auto& scope : scopes) {
         if (scope.symbol_table.count(id)) {
             return scope;
@@ -113,6 +120,7 @@ scope& falk::symbol_mapper::scope_of(const std::string& id) {
 
 falk::symbol::type
 falk::symbol_mapper::type_of(const std::string& id) const {
+    stats::count(stats::event::LOOKUP);
     for (auto& scope : scopes) {
         if (scope.symbol_table.count(id)) {
             return scope.symbol_table.at(id);
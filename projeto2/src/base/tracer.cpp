@@ -0,0 +1,184 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "base/tracer.hpp"
+#include "types/variable.hpp"
+
+namespace {
+    using steady = std::chrono::steady_clock;
+
+    struct event {
+        char phase;
+        double timestamp;
+        std::string name;
+        std::string args;
+    };
+
+    struct buffer {
+        size_t thread;
+        std::vector<event> events;
+    };
+
+    std::string path;
+    steady::time_point origin;
+    std::mutex lock;
+    std::vector<std::unique_ptr<buffer>> buffers;
+    // buffers of threads that have ended, to be taken by new ones
+    std::vector<buffer*> idle;
+
+    // Buffers outlive their threads, to be written at exit. Kernels start
+    // threads on every call, so a thread that ends hands its buffer on,
+    // which keeps one trace row per concurrent worker.
+    struct owner {
+        buffer* current = nullptr;
+
+        ~owner() {
+            if (current) {
+                std::lock_guard<std::mutex> guard(lock);
+                idle.push_back(current);
+            }
+        }
+    };
+
+    thread_local owner local;
+
+    buffer& own() {
+        if (!local.current) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (idle.empty()) {
+                buffers.push_back(std::make_unique<buffer>());
+                buffers.back()->thread = buffers.size();
+                local.current = buffers.back().get();
+            } else {
+                local.current = idle.back();
+                idle.pop_back();
+            }
+        }
+        return *local.current;
+    }
+
+    double now() {
+        std::chrono::duration<double, std::micro> elapsed =
+            steady::now() - origin;
+        return elapsed.count();
+    }
+
+    std::string escape(const std::string& text) {
+        std::string result;
+        for (auto c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+                result += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char code[7];
+                std::snprintf(code, sizeof(code), "\\u%04x", c);
+                result += code;
+            } else {
+                result += c;
+            }
+        }
+        return result;
+    }
+
+    void write(std::ostream& out, const event& e, size_t thread) {
+        out << "{\"ph\": \"" << e.phase << "\", \"pid\": 1, \"tid\": "
+            << thread << ", \"ts\": " << e.timestamp;
+        if (!e.name.empty()) {
+            out << ", \"name\": \"" << escape(e.name) << "\"";
+        }
+        if (!e.args.empty()) {
+            out << ", \"args\": {" << e.args << "}";
+        }
+        out << "}";
+    }
+}
+
+bool falk::trace::enabled = false;
+
+void falk::trace::start(const std::string& file) {
+    path = file;
+    origin = steady::now();
+    enabled = true;
+    // the interpreter is the first thread
+    own();
+}
+
+bool falk::trace::finish() {
+    std::ofstream out(path);
+    std::lock_guard<std::mutex> guard(lock);
+    out << std::fixed;
+    out.precision(3);
+    out << "{\"traceEvents\": [\n";
+    bool first = true;
+    for (auto& b : buffers) {
+        auto name = b->thread == 1
+                  ? std::string("interpreter")
+                  : "worker " + std::to_string(b->thread - 1);
+        out << (first ? "" : ",\n") << "{\"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << b->thread << ", \"name\": \"thread_name\", \"args\": "
+            << "{\"name\": \"" << name << "\"}}";
+        first = false;
+        for (auto& e : b->events) {
+            out << ",\n";
+            write(out, e, b->thread);
+        }
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    return bool(out);
+}
+
+void falk::trace::begin(const std::string& name, const std::string& args) {
+    own().events.push_back({'B', now(), name, args});
+}
+
+void falk::trace::end(const std::string& args) {
+    own().events.push_back({'E', now(), std::string(), args});
+}
+
+std::string falk::trace::field(const std::string& key,
+                               const std::string& value) {
+    return "\"" + escape(key) + "\": \"" + escape(value) + "\"";
+}
+
+std::string falk::trace::shape(const array& value) {
+    return "array[" + std::to_string(value.size()) + "]";
+}
+
+std::string falk::trace::shape(const matrix& value) {
+    return "matrix[" + std::to_string(value.row_count()) + ", "
+         + std::to_string(value.column_count()) + "]";
+}
+
+std::string falk::trace::shape(const variable& value) {
+    switch (value.stored_type()) {
+        case structural::type::SCALAR:
+            return "scalar";
+        case structural::type::ARRAY:
+            return shape(value.value<array>());
+        case structural::type::MATRIX:
+            return shape(value.value<matrix>());
+        case structural::type::DICT:
+            return "dict{" + std::to_string(value.value<dict>().size()) + "}";
+    }
+    return "";
+}
+
+size_t falk::trace::elements(const variable& value) {
+    switch (value.stored_type()) {
+        case structural::type::SCALAR:
+            break;
+        case structural::type::ARRAY:
+            return value.value<array>().size();
+        case structural::type::MATRIX: {
+            auto& m = value.value<matrix>();
+            return m.row_count() * m.column_count();
+        }
+        case structural::type::DICT:
+            return value.value<dict>().size();
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "base/evaluator.hpp"
+#include "lib/arguments.hpp"
+
+using S = falk::structural::type;
+
+bool falk::lib::array_of(evaluator& ev, const builtins::node_ptr& node,
+                         const std::string& fn, array& result) {
+    auto value = ev.evaluate(node);
+    if (value.error()) {
+        return false;
+    }
+
+    if (value.stored_type() != S::ARRAY) {
+        err::semantic<Error::INVALID_ARGUMENT>(fn, "expected an array");
+        return false;
+    }
+    result = std::move(value.value<array>());
+    return true;
+}
+
+bool falk::lib::scalar_of(evaluator& ev, const builtins::node_ptr& node,
+                          const std::string& fn, scalar& result) {
+    auto value = ev.evaluate(node);
+    if (value.error()) {
+        return false;
+    }
+
+    if (value.stored_type() != S::SCALAR) {
+        err::semantic<Error::INVALID_ARGUMENT>(fn, "expected a scalar");
+        return false;
+    }
+    result = value.value<scalar>();
+    return true;
+}
+
+bool falk::lib::flag_of(evaluator& ev, const arguments& args,
+                        size_t position, const std::string& fn,
+                        bool& flag) {
+    flag = false;
+    scalar value;
+    if (args.size() <= position) {
+        return true;
+    }
+
+    if (!scalar_of(ev, args[position], fn, value)) {
+        return false;
+    }
+    flag = value.boolean();
+    return true;
+}
+
+bool falk::lib::function_of(evaluator& ev, const builtins::node_ptr& node,
+                            const std::string& fn, std::string& result) {
+    result = ev.function_of(node);
+    if (result.empty()) {
+        err::semantic<Error::INVALID_ARGUMENT>(fn, "expected a function");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#include "base/evaluator.hpp"
+#include "lib/containers.hpp"
+
+namespace {
+    using falk::evaluator;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+
+    // Resolves the structure changed by a builtin, reporting an error
+    // if the first argument is not an array or matrix variable.
+    variable* structure(evaluator& ev, const falk::lib::arguments& args,
+                        const std::string& fn) {
+        auto target = ev.reference(args[0]);
+        if (!target || (target->stored_type() != S::ARRAY
+                        && target->stored_type() != S::MATRIX)) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "expected an array or matrix variable");
+            return nullptr;
+        }
+        return target;
+    }
+
+    // Appends a value to a structure, checking the shapes first so that
+    // a mismatch does not invalidate the variable.
+    bool push_back(variable& target, const variable& value,
+                   const std::string& fn) {
+        if (target.stored_type() == S::ARRAY) {
+            if (value.stored_type() != S::SCALAR) {
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "only scalars can be added to an array");
+                return false;
+            }
+            target.value<falk::array>().push_back(value.value<scalar>());
+            return true;
+        }
+
+        auto& m = target.value<falk::matrix>();
+        if (value.stored_type() != S::ARRAY) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "only arrays can be added to a matrix");
+            return false;
+        }
+
+        auto& row = value.value<falk::array>();
+        if (m.row_count() > 0 && row.size() != m.column_count()) {
+            err::semantic<Error::WRONG_COLUMN_COUNT>(m.column_count(),
+                                                     row.size());
+            return false;
+        }
+        m.push_back(row);
+        return true;
+    }
+}
+
+void falk::lib::append(evaluator& ev, arguments& args) {
+    auto target = structure(ev, args, "append");
+    auto value = ev.evaluate(args[1]);
+    if (!target || value.error() || !push_back(*target, value, "append")) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    ev.push(scalar::silent());
+}
+
+void falk::lib::pop(evaluator& ev, arguments& args) {
+    auto target = structure(ev, args, "pop");
+    if (!target) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (target->stored_type() == S::ARRAY) {
+        auto& values = target->value<array>();
+        if (values.size() > 0) {
+            ev.push(values.pop_back());
+            return;
+        }
+    } else {
+        auto& rows = target->value<matrix>();
+        if (rows.row_count() > 0) {
+            ev.push(rows.pop_back());
+            return;
+        }
+    }
+
+    err::semantic<Error::ILLEGAL_OPERATION>("pop from an empty structure");
+    ev.push(scalar::invalid());
+}
+
+void falk::lib::extend(evaluator& ev, arguments& args) {
+    auto target = structure(ev, args, "extend");
+    auto source = ev.evaluate(args[1]);
+    if (!target || source.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (source.stored_type() != target->stored_type()) {
+        err::semantic<Error::INVALID_ARGUMENT>("extend",
+            "both structures must be of the same kind");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (target->stored_type() == S::ARRAY) {
+        target->value<array>().extend(source.value<array>());
+    } else {
+        auto& rows = source.value<matrix>();
+        auto& m = target->value<matrix>();
+        m.reserve(m.row_count() + rows.row_count(), rows.column_count());
+        for (size_t i = 0; i < rows.row_count(); i++) {
+            if (!push_back(*target, variable(rows.row(i)), "extend")) {
+                ev.push(scalar::invalid());
+                return;
+            }
+        }
+    }
+    ev.push(scalar::silent());
+}
+
+void falk::lib::reserve(evaluator& ev, arguments& args) {
+    auto target = structure(ev, args, "reserve");
+    auto count = ev.evaluate(args[1]);
+    if (!target || count.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (count.stored_type() != S::SCALAR
+        || count.value<scalar>().integer() < 0) {
+        err::semantic<Error::INVALID_ARGUMENT>("reserve",
+            "the capacity must be a non-negative scalar");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    size_t capacity = count.value<scalar>().integer();
+    bool reserved;
+    if (target->stored_type() == S::ARRAY) {
+        reserved = target->value<array>().reserve(capacity);
+    } else {
+        auto& m = target->value<matrix>();
+        reserved = m.reserve(capacity, m.column_count());
+    }
+
+    if (!reserved) {
+        err::semantic<Error::INVALID_ARGUMENT>("reserve",
+            "the capacity is too large");
+        ev.push(scalar::invalid());
+        return;
+    }
+    ev.push(scalar::silent());
+}
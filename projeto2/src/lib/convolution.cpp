@@ -0,0 +1,378 @@
+#include <cmath>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/convolution.hpp"
+#include "lib/fft.hpp"
+#include "lib/parallel.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+    using complex = spectral::complex;
+    namespace trace = falk::trace;
+
+    // columns of the result computed at once, by each thread, for each
+    // element of the kernel
+    constexpr size_t TILE = 512;
+    // smaller kernels are always applied directly
+    constexpr size_t FFT_MIN_KERNEL = 32;
+    // operations of an FFT of size n, per n log2(n)
+    constexpr double FFT_COST = 5;
+
+    enum class mode { FULL, SAME, VALID };
+    // kinds of arguments accepted
+    enum class kind { ARRAYS, MATRICES, EITHER };
+
+    // Values in row-major order; arrays are a single row.
+    template<typename T>
+    struct grid {
+        size_t rows = 0;
+        size_t columns = 0;
+        std::vector<T> values;
+
+        T& operator()(size_t i, size_t j) {
+            return values[i * columns + j];
+        }
+
+        const T& operator()(size_t i, size_t j) const {
+            return values[i * columns + j];
+        }
+    };
+
+    // The part of the full convolution that is kept.
+    struct window {
+        size_t row;
+        size_t rows;
+        size_t column;
+        size_t columns;
+    };
+
+    // first index and size kept, along a dimension of size n with a
+    // kernel of size k
+    std::pair<size_t, size_t> extent(size_t n, size_t k, mode m) {
+        switch (m) {
+            case mode::FULL:
+                return {0, n + k - 1};
+            case mode::SAME:
+                return {k / 2, n};
+            default:
+                return {k - 1, n >= k ? n - k + 1 : 0};
+        }
+    }
+
+    // smallest size not less than n without prime factors above 5
+    size_t smooth(size_t n) {
+        for (;; n++) {
+            auto m = n;
+            for (size_t p : {2, 3, 5}) {
+                while (m % p == 0) {
+                    m /= p;
+                }
+            }
+            if (m == 1) {
+                return n;
+            }
+        }
+    }
+
+    // Applies the kernel to each tile (part of a row) of the result,
+    // kernel element by kernel element, so that the inner loop runs over
+    // contiguous columns.
+    template<typename T>
+    grid<T> direct(const grid<T>& a, const grid<T>& k, const window& w) {
+        grid<T> result{w.rows, w.columns, std::vector<T>(w.rows * w.columns)};
+        auto tiles = (w.columns + TILE - 1) / TILE;
+        auto items = w.rows * tiles;
+        auto count = std::min(workers(items * TILE * k.rows * k.columns),
+                              std::max<size_t>(items, 1));
+        parallel(count, [&](size_t t) {
+            auto end = items * (t + 1) / count;
+            for (auto item = items * t / count; item < end; item++) {
+                auto i = item / tiles;
+                auto first = (item % tiles) * TILE;
+                auto last = std::min(first + TILE, w.columns);
+                auto r = w.row + i;
+                auto target = result.values.data() + i * w.columns;
+                for (size_t p = 0; p < k.rows; p++) {
+                    if (r < p || r - p >= a.rows) {
+                        continue;
+                    }
+
+                    // result column j reads column w.column + j - q
+                    auto source = a.values.data() + (r - p) * a.columns;
+                    for (size_t q = 0; q < k.columns; q++) {
+                        auto coefficient = k(p, q);
+                        auto low = std::max(first,
+                            q > w.column ? q - w.column : 0);
+                        auto high = std::min(last,
+                            a.columns + q > w.column ? a.columns + q - w.column : 0);
+                        for (auto j = low; j < high; j++) {
+                            target[j] += source[w.column + j - q] * coefficient;
+                        }
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    void store(double& target, complex value) {
+        target = value.real();
+    }
+
+    void store(complex& target, complex value) {
+        target = value;
+    }
+
+    // size of the (zero padded) transforms
+    std::pair<size_t, size_t> padded(const grid<complex>& a,
+                                     const grid<complex>& k) {
+        return {smooth(a.rows + k.rows - 1), smooth(a.columns + k.columns - 1)};
+    }
+
+    // Multiplies the transforms of the operands, zero padded so that
+    // the circular convolution holds the full one.
+    template<typename T>
+    grid<T> transformed(const grid<complex>& a, const grid<complex>& k,
+                        const window& w) {
+        auto size = padded(a, k);
+        auto rows = size.first;
+        auto columns = size.second;
+        std::vector<complex> x(rows * columns), y(rows * columns);
+        for (size_t i = 0; i < a.rows; i++) {
+            std::copy_n(&a.values[i * a.columns], a.columns, &x[i * columns]);
+        }
+        for (size_t i = 0; i < k.rows; i++) {
+            std::copy_n(&k.values[i * k.columns], k.columns, &y[i * columns]);
+        }
+
+        spectral::forward2(x, rows, columns);
+        spectral::forward2(y, rows, columns);
+        for (size_t i = 0; i < x.size(); i++) {
+            x[i] *= y[i];
+        }
+        spectral::inverse2(x, rows, columns);
+
+        grid<T> result{w.rows, w.columns, std::vector<T>(w.rows * w.columns)};
+        for (size_t i = 0; i < w.rows; i++) {
+            for (size_t j = 0; j < w.columns; j++) {
+                store(result(i, j), x[(w.row + i) * columns + w.column + j]);
+            }
+        }
+        return result;
+    }
+
+    bool use_fft(const grid<complex>& a, const grid<complex>& k,
+                 const window& w) {
+        auto kernel = k.rows * k.columns;
+        if (kernel < FFT_MIN_KERNEL || a.values.empty()) {
+            return false;
+        }
+
+        auto size = padded(a, k);
+        double n = double(size.first) * size.second;
+        double direct = double(w.rows) * w.columns * kernel;
+        return 3 * FFT_COST * n * std::log2(n) < direct;
+    }
+
+    template<typename T>
+    grid<T> narrowed(const grid<complex>& g) {
+        grid<T> result{g.rows, g.columns, std::vector<T>(g.values.size())};
+        for (size_t i = 0; i < g.values.size(); i++) {
+            store(result.values[i], g.values[i]);
+        }
+        return result;
+    }
+
+    template<typename T>
+    grid<T> convolve(const grid<complex>& a, const grid<complex>& k,
+                     const window& w) {
+        if (use_fft(a, k, w)) {
+            return transformed<T>(a, k, w);
+        }
+        return direct(narrowed<T>(a), narrowed<T>(k), w);
+    }
+
+    // An argument, as complex numbers, and what it was.
+    struct operand {
+        grid<complex> values;
+        bool complex;
+        bool is_matrix;
+    };
+
+    bool operand_of(evaluator& ev, const falk::builtins::node_ptr& node,
+                    const std::string& fn, operand& result) {
+        auto value = ev.evaluate(node);
+        if (value.error()) {
+            return false;
+        }
+
+        auto& g = result.values;
+        g.values.clear();
+        switch (value.stored_type()) {
+            case S::ARRAY: {
+                const auto& a = value.value<array>();
+                g.rows = 1;
+                g.columns = a.size();
+                for (auto element : a) {
+                    g.values.emplace_back(element.real(), element.imag());
+                }
+                result.complex = a.inner_type() == falk::type::COMPLEX;
+                result.is_matrix = false;
+                return true;
+            }
+            case S::MATRIX: {
+                const auto& m = value.value<matrix>();
+                g.rows = m.row_count();
+                g.columns = m.column_count();
+                result.complex = false;
+                for (size_t i = 0; i < g.rows; i++) {
+                    for (size_t j = 0; j < g.columns; j++) {
+                        auto element = m.unchecked(i, j);
+                        g.values.emplace_back(element.real(), element.imag());
+                        result.complex |=
+                            element.inner_type() == falk::type::COMPLEX;
+                    }
+                }
+                result.is_matrix = true;
+                return true;
+            }
+            default:
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "expected an array or matrix");
+                return false;
+        }
+    }
+
+    // as given by trace::shape()
+    std::string shape(const operand& o) {
+        if (!o.is_matrix) {
+            return "array[" + std::to_string(o.values.columns) + "]";
+        }
+        return "matrix[" + std::to_string(o.values.rows) + ", "
+             + std::to_string(o.values.columns) + "]";
+    }
+
+    bool mode_of(evaluator& ev, arguments& args, const std::string& fn,
+                 mode fallback, mode& result) {
+        if (args.size() < 3) {
+            result = fallback;
+            return true;
+        }
+
+        scalar value;
+        if (!scalar_of(ev, args[2], fn, value)) {
+            return false;
+        }
+
+        if (value.inner_type() != falk::type::INT
+            || value.integer() < 0 || value.integer() > 2) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "mode must be 0 (full), 1 (same) or 2 (valid)");
+            return false;
+        }
+        result = static_cast<mode>(value.integer());
+        return true;
+    }
+
+    template<typename T>
+    array row_of(const grid<T>& g, size_t i) {
+        array result;
+        result.reserve(g.columns);
+        for (size_t j = 0; j < g.columns; j++) {
+            result.push_back(scalar(g(i, j)));
+        }
+        return result;
+    }
+
+    template<typename T>
+    void push(evaluator& ev, const grid<T>& g, bool is_matrix) {
+        if (!is_matrix) {
+            ev.push(row_of(g, 0));
+            return;
+        }
+
+        matrix result;
+        result.reserve(g.rows, g.columns);
+        for (size_t i = 0; i < g.rows; i++) {
+            result.push_back(row_of(g, i));
+        }
+        ev.push(result);
+    }
+
+    // Convolution of two arguments of the same kind; a stencil uses the
+    // kernel reversed.
+    void apply(evaluator& ev, arguments& args, const std::string& fn,
+               kind accepted, mode fallback, bool reversed) {
+        operand a, k;
+        mode m;
+        if (!operand_of(ev, args[0], fn, a) || !operand_of(ev, args[1], fn, k)
+            || !mode_of(ev, args, fn, fallback, m)) {
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (accepted == kind::ARRAYS && (a.is_matrix || k.is_matrix)) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "expected arrays");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (accepted == kind::MATRICES && (!a.is_matrix || !k.is_matrix)) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "expected matrices");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (a.is_matrix != k.is_matrix) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "expected two arrays or two matrices");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (k.values.values.empty()) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "empty kernel");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        trace::span traced{fn, a.values.values.size() + k.values.values.size(),
+                           [&] {
+            return trace::field("x", shape(a)) + ", "
+                 + trace::field("kernel", shape(k));
+        }};
+
+        auto& kernel = k.values.values;
+        if (reversed) {
+            std::reverse(kernel.begin(), kernel.end());
+        }
+
+        auto rows = extent(a.values.rows, k.values.rows, m);
+        auto columns = extent(a.values.columns, k.values.columns, m);
+        window w{rows.first, rows.second, columns.first, columns.second};
+        if (a.complex || k.complex) {
+            push(ev, convolve<complex>(a.values, k.values, w), a.is_matrix);
+        } else {
+            push(ev, convolve<double>(a.values, k.values, w), a.is_matrix);
+        }
+    }
+}
+
+void falk::lib::conv(evaluator& ev, arguments& args) {
+    apply(ev, args, "conv", kind::ARRAYS, mode::FULL, false);
+}
+
+void falk::lib::conv2(evaluator& ev, arguments& args) {
+    apply(ev, args, "conv2", kind::MATRICES, mode::FULL, false);
+}
+
+void falk::lib::stencil(evaluator& ev, arguments& args) {
+    apply(ev, args, "stencil", kind::EITHER, mode::SAME, true);
+}
@@ -0,0 +1,210 @@
+#include <sstream>
+
+#include "base/evaluator.hpp"
+#include "lib/dicts.hpp"
+
+namespace {
+    using falk::dict;
+    using falk::evaluator;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+
+    // Resolves the dict read by a builtin. Variables are used in place,
+    // so that lookups do not copy the whole dict; other expressions are
+    // evaluated into holder.
+    const dict* lookup(evaluator& ev, const falk::lib::arguments& args,
+                       const std::string& fn, variable& holder) {
+        auto source = ev.reference(args[0]);
+        if (!source) {
+            holder = ev.evaluate(args[0]);
+            source = &holder;
+        }
+
+        if (source->error()) {
+            return nullptr;
+        }
+
+        if (source->stored_type() != S::DICT) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "expected a dict");
+            return nullptr;
+        }
+        return &source->value<dict>();
+    }
+
+    // Evaluates the key argument of a builtin.
+    bool key_of(evaluator& ev, const falk::builtins::node_ptr& node,
+                const std::string& fn, scalar& key) {
+        auto value = ev.evaluate(node);
+        if (value.error()) {
+            return false;
+        }
+
+        if (value.stored_type() != S::SCALAR) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "keys must be scalars");
+            return false;
+        }
+        key = value.value<scalar>();
+        return true;
+    }
+
+    void missing(const scalar& key) {
+        std::ostringstream text;
+        text << key;
+        err::semantic<Error::KEY_NOT_FOUND>(text.str());
+    }
+}
+
+void falk::lib::todict(evaluator& ev, arguments& args) {
+    auto keys = ev.evaluate(args[0]);
+    auto values = ev.evaluate(args[1]);
+    if (keys.error() || values.error()) {
+        ev.push(dict(true));
+        return;
+    }
+
+    if (keys.stored_type() != S::ARRAY) {
+        err::semantic<Error::INVALID_ARGUMENT>("todict",
+            "the keys must be an array");
+        ev.push(dict(true));
+        return;
+    }
+
+    const auto& k = keys.value<array>();
+    size_t count;
+    switch (values.stored_type()) {
+        case S::ARRAY:
+            count = values.value<array>().size();
+            break;
+        case S::MATRIX:
+            count = values.value<matrix>().row_count();
+            break;
+        default:
+            count = -1;
+    }
+
+    if (count != k.size()) {
+        err::semantic<Error::INVALID_ARGUMENT>("todict",
+            "expected one value (or row) per key");
+        ev.push(dict(true));
+        return;
+    }
+
+    dict result;
+    for (size_t i = 0; i < count; i++) {
+        if (values.stored_type() == S::ARRAY) {
+            result.insert(k[i], variable(values.value<array>().unchecked(i)));
+        } else {
+            result.insert(k[i], variable(values.value<matrix>().row(i)));
+        }
+    }
+    ev.push(result);
+}
+
+void falk::lib::has(evaluator& ev, arguments& args) {
+    variable holder;
+    scalar key;
+    auto d = lookup(ev, args, "has", holder);
+    if (!d || !key_of(ev, args[1], "has", key)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    ev.push(scalar(d->find(key) != nullptr));
+}
+
+void falk::lib::get(evaluator& ev, arguments& args) {
+    variable holder;
+    scalar key;
+    auto d = lookup(ev, args, "get", holder);
+    if (!d || !key_of(ev, args[1], "get", key)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (auto value = d->find(key)) {
+        ev.push(*value);
+    } else if (args.size() > 2) {
+        ev.push(ev.evaluate(args[2]));
+    } else {
+        missing(key);
+        ev.push(scalar::invalid());
+    }
+}
+
+void falk::lib::remove(evaluator& ev, arguments& args) {
+    auto target = ev.reference(args[0]);
+    scalar key;
+    if (!target || target->stored_type() != S::DICT) {
+        err::semantic<Error::INVALID_ARGUMENT>("remove",
+            "expected a dict variable");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (!key_of(ev, args[1], "remove", key)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (!target->value<dict>().erase(key)) {
+        missing(key);
+        ev.push(scalar::invalid());
+        return;
+    }
+    ev.push(scalar::silent());
+}
+
+void falk::lib::keys(evaluator& ev, arguments& args) {
+    variable holder;
+    auto d = lookup(ev, args, "keys", holder);
+    if (!d) {
+        ev.push(array(true));
+        return;
+    }
+    ev.push(d->keys());
+}
+
+void falk::lib::values(evaluator& ev, arguments& args) {
+    variable holder;
+    auto d = lookup(ev, args, "values", holder);
+    if (!d) {
+        ev.push(array(true));
+        return;
+    }
+
+    // scalars make an array and arrays of the same size a matrix
+    array elements;
+    matrix rows;
+    auto shape = S::SCALAR;
+    bool valid = true;
+    d->for_each([&](const scalar&, const variable& value) {
+        auto type = value.stored_type();
+        if (elements.size() + rows.row_count() == 0) {
+            shape = type;
+        }
+
+        if (type != shape || type == S::MATRIX) {
+            valid = false;
+        } else if (type == S::SCALAR) {
+            elements.push_back(value.value<scalar>());
+        } else {
+            auto& row = value.value<array>();
+            if (rows.row_count() > 0 && row.size() != rows.column_count()) {
+                valid = false;
+            } else {
+                rows.push_back(row);
+            }
+        }
+    });
+
+    if (!valid) {
+        err::semantic<Error::INVALID_ARGUMENT>("values",
+            "the values must be all scalars or arrays of the same size");
+        ev.push(array(true));
+    } else if (shape == S::ARRAY) {
+        ev.push(rows);
+    } else {
+        ev.push(elements);
+    }
+}
@@ -0,0 +1,488 @@
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/fft.hpp"
+#include "lib/parallel.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+    using complex = spectral::complex;
+    namespace trace = falk::trace;
+
+    constexpr double PI = 3.14159265358979323846;
+    // sizes with larger prime factors use Bluestein's algorithm
+    constexpr size_t MAX_RADIX = 32;
+
+    // e^(-2 pi i k / n), exact at the multiples of a quarter turn
+    complex unit(uint64_t k, uint64_t n) {
+        k %= n;
+        if ((4 * k) % n == 0) {
+            static const complex quarters[] = {{1, 0}, {0, -1}, {-1, 0}, {0, 1}};
+            return quarters[4 * k / n];
+        }
+        auto angle = -2 * PI * k / n;
+        return {std::cos(angle), std::sin(angle)};
+    }
+
+    // One pass of the Stockham FFT: DFTs of size radix over elements
+    // n / radix apart, multiplied by the twiddle factors of the
+    // elements already combined (span, the product of the previous
+    // radices).
+    struct stage {
+        size_t radix;
+        size_t span;
+        // twiddles[q * radix + r] for q < span, r < radix
+        std::vector<complex> twiddles;
+        // roots of unity of the radix, for radices without a kernel
+        std::vector<complex> roots;
+    };
+
+    struct plan {
+        size_t size;
+        std::vector<stage> stages;
+        // for Bluestein's algorithm: the power of 2 plan in which the
+        // convolution is computed, the chirp e^(-pi i k^2 / n) and the
+        // transform of its conjugate
+        std::shared_ptr<const plan> padded;
+        std::vector<complex> chirp;
+        std::vector<complex> filter;
+    };
+
+    void run(const plan&, complex*);
+
+    // conjugate without negative zeros, which would be printed
+    complex conjugate(complex value) {
+        return {value.real(), 0 - value.imag()};
+    }
+
+    // prime factors of n, grouping factors 2 in pairs
+    std::vector<size_t> factors(size_t n) {
+        std::vector<size_t> result;
+        while (n % 4 == 0) {
+            result.push_back(4);
+            n /= 4;
+        }
+        if (n % 2 == 0) {
+            result.push_back(2);
+            n /= 2;
+        }
+        for (size_t p = 3; p * p <= n; p += 2) {
+            while (n % p == 0) {
+                result.push_back(p);
+                n /= p;
+            }
+        }
+        if (n > 1) {
+            result.push_back(n);
+        }
+        return result;
+    }
+
+    std::mutex plans_mutex;
+    std::unordered_map<size_t, std::shared_ptr<const plan>> plans;
+
+    std::shared_ptr<const plan> plan_of(size_t);
+
+    std::shared_ptr<const plan> build(size_t n) {
+        auto result = std::make_shared<plan>();
+        result->size = n;
+        auto radices = factors(n);
+        if (*std::max_element(radices.begin(), radices.end()) <= MAX_RADIX) {
+            size_t span = 1;
+            for (auto radix : radices) {
+                stage s{radix, span, {}, {}};
+                s.twiddles.reserve(span * radix);
+                for (size_t q = 0; q < span; q++) {
+                    for (size_t r = 0; r < radix; r++) {
+                        s.twiddles.push_back(unit(q * r, span * radix));
+                    }
+                }
+                for (size_t r = 0; r < radix; r++) {
+                    s.roots.push_back(unit(r, radix));
+                }
+                result->stages.push_back(std::move(s));
+                span *= radix;
+            }
+            return result;
+        }
+
+        size_t padded = 1;
+        while (padded < 2 * n - 1) {
+            padded *= 2;
+        }
+        result->padded = plan_of(padded);
+        result->chirp.resize(n);
+        for (uint64_t k = 0; k < n; k++) {
+            result->chirp[k] = unit(k * k % (2 * n), 2 * n);
+        }
+
+        result->filter.resize(padded);
+        result->filter[0] = std::conj(result->chirp[0]);
+        for (size_t k = 1; k < n; k++) {
+            result->filter[k] = result->filter[padded - k]
+                              = std::conj(result->chirp[k]);
+        }
+        run(*result->padded, result->filter.data());
+        return result;
+    }
+
+    std::shared_ptr<const plan> plan_of(size_t n) {
+        {
+            std::lock_guard<std::mutex> lock(plans_mutex);
+            auto it = plans.find(n);
+            if (it != plans.end()) {
+                return it->second;
+            }
+        }
+
+        // built unlocked, as Bluestein plans need another plan
+        auto result = build(n);
+        std::lock_guard<std::mutex> lock(plans_mutex);
+        return plans.emplace(n, result).first->second;
+    }
+
+    // DFT of the values of a stage, in place
+    void butterfly(complex* v, const stage& s) {
+        switch (s.radix) {
+            case 2: {
+                auto a = v[0];
+                v[0] = a + v[1];
+                v[1] = a - v[1];
+                break;
+            }
+            case 3: {
+                constexpr double SIN_60 = 0.86602540378443864676;
+                auto sum = v[1] + v[2];
+                auto half = v[0] - 0.5 * sum;
+                auto diff = v[1] - v[2];
+                auto rotated = complex(SIN_60 * diff.imag(), -SIN_60 * diff.real());
+                v[0] += sum;
+                v[1] = half + rotated;
+                v[2] = half - rotated;
+                break;
+            }
+            case 4: {
+                auto a0 = v[0] + v[2];
+                auto a1 = v[0] - v[2];
+                auto a2 = v[1] + v[3];
+                auto diff = v[1] - v[3];
+                auto a3 = complex(diff.imag(), -diff.real());
+                v[0] = a0 + a2;
+                v[1] = a1 + a3;
+                v[2] = a0 - a2;
+                v[3] = a1 - a3;
+                break;
+            }
+            default: {
+                complex result[MAX_RADIX];
+                for (size_t k = 0; k < s.radix; k++) {
+                    complex sum = 0;
+                    for (size_t r = 0, e = 0; r < s.radix; r++) {
+                        sum += v[r] * s.roots[e];
+                        e += k;
+                        if (e >= s.radix) {
+                            e -= s.radix;
+                        }
+                    }
+                    result[k] = sum;
+                }
+                std::copy(result, result + s.radix, v);
+            }
+        }
+    }
+
+    void pass(const complex* in, complex* out, size_t n, const stage& s) {
+        auto radix = s.radix;
+        auto span = s.span;
+        auto stride = n / radix;
+        auto count = workers(n);
+        parallel(count, [&](size_t t) {
+            auto begin = stride * t / count;
+            auto end = stride * (t + 1) / count;
+            complex v[MAX_RADIX];
+            auto q = begin % span;
+            for (auto j = begin; j < end; j++) {
+                auto twiddles = s.twiddles.data() + q * radix;
+                for (size_t r = 0; r < radix; r++) {
+                    v[r] = in[j + r * stride] * twiddles[r];
+                }
+                butterfly(v, s);
+                auto base = (j - q) * radix + q;
+                for (size_t r = 0; r < radix; r++) {
+                    out[base + r * span] = v[r];
+                }
+                if (++q == span) {
+                    q = 0;
+                }
+            }
+        });
+    }
+
+    // forward transform of p.size elements, in place
+    void run(const plan& p, complex* data) {
+        auto n = p.size;
+        if (p.padded) {
+            auto m = p.padded->size;
+            std::vector<complex> buffer(m);
+            for (size_t k = 0; k < n; k++) {
+                buffer[k] = data[k] * p.chirp[k];
+            }
+            run(*p.padded, buffer.data());
+
+            // inverse transform of the product, by conjugation
+            for (size_t k = 0; k < m; k++) {
+                buffer[k] = conjugate(buffer[k] * p.filter[k]);
+            }
+            run(*p.padded, buffer.data());
+            for (size_t k = 0; k < n; k++) {
+                data[k] = conjugate(buffer[k]) * p.chirp[k] / double(m);
+            }
+            return;
+        }
+
+        std::vector<complex> work(n);
+        auto in = data;
+        auto out = work.data();
+        for (auto& s : p.stages) {
+            pass(in, out, n, s);
+            std::swap(in, out);
+        }
+        if (in != data) {
+            std::copy(in, in + n, data);
+        }
+    }
+
+    bool sequence_of(evaluator& ev, const falk::builtins::node_ptr& node,
+                     const std::string& fn, std::vector<complex>& result) {
+        auto value = ev.evaluate(node);
+        if (value.error()) {
+            return false;
+        }
+
+        if (value.stored_type() != S::ARRAY) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "expected an array");
+            return false;
+        }
+
+        const auto& a = value.value<array>();
+        result.clear();
+        result.reserve(a.size());
+        for (auto element : a) {
+            result.emplace_back(element.real(), element.imag());
+        }
+        return true;
+    }
+
+    array array_of(const complex* values, size_t n) {
+        array result;
+        result.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            result.push_back(scalar(values[i]));
+        }
+        return result;
+    }
+
+    // transforms each row of a matrix stored in row-major order, rows
+    // split among threads
+    void transform_rows(std::vector<complex>& data, size_t rows,
+                        size_t columns, bool inverse) {
+        auto count = std::min(workers(data.size()), rows);
+        parallel(count, [&](size_t t) {
+            std::vector<complex> line(columns);
+            auto end = rows * (t + 1) / count;
+            for (auto i = rows * t / count; i < end; i++) {
+                auto first = data.begin() + i * columns;
+                std::copy(first, first + columns, line.begin());
+                if (inverse) {
+                    spectral::inverse(line);
+                } else {
+                    spectral::forward(line);
+                }
+                std::copy(line.begin(), line.end(), first);
+            }
+        });
+    }
+
+    std::vector<complex> transposed(const std::vector<complex>& data,
+                                    size_t rows, size_t columns) {
+        std::vector<complex> result(data.size());
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < columns; j++) {
+                result[j * rows + i] = data[i * columns + j];
+            }
+        }
+        return result;
+    }
+
+    // 2-D transform: of the rows, then of the columns
+    void transform2(std::vector<complex>& data, size_t rows, size_t columns,
+                    bool inverse) {
+        if (!data.empty()) {
+            transform_rows(data, rows, columns, inverse);
+            data = transposed(data, rows, columns);
+            transform_rows(data, columns, rows, inverse);
+            data = transposed(data, columns, rows);
+        }
+    }
+
+    void transform_matrix(evaluator& ev, arguments& args,
+                          const std::string& fn, bool inverse) {
+        auto value = ev.evaluate(args[0]);
+        if (value.error()) {
+            ev.push(matrix(true));
+            return;
+        }
+
+        if (value.stored_type() != S::MATRIX) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn, "expected a matrix");
+            ev.push(matrix(true));
+            return;
+        }
+
+        const auto& m = value.value<matrix>();
+        auto rows = m.row_count();
+        auto columns = m.column_count();
+        trace::span traced{fn, rows * columns, [&] {
+            return trace::field("x", trace::shape(m));
+        }};
+        std::vector<complex> data;
+        data.reserve(rows * columns);
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < columns; j++) {
+                auto element = m.unchecked(i, j);
+                data.emplace_back(element.real(), element.imag());
+            }
+        }
+
+        transform2(data, rows, columns, inverse);
+
+        matrix result;
+        result.reserve(rows, columns);
+        for (size_t i = 0; i < rows; i++) {
+            result.push_back(array_of(data.data() + i * columns, columns));
+        }
+        ev.push(result);
+    }
+}
+
+void falk::lib::spectral::forward(std::vector<complex>& data) {
+    if (data.size() > 1) {
+        run(*plan_of(data.size()), data.data());
+    }
+}
+
+void falk::lib::spectral::inverse(std::vector<complex>& data) {
+    for (auto& value : data) {
+        value = conjugate(value);
+    }
+    forward(data);
+    for (auto& value : data) {
+        value = conjugate(value) / double(data.size());
+    }
+}
+
+void falk::lib::spectral::forward2(std::vector<complex>& data, size_t rows,
+                                   size_t columns) {
+    transform2(data, rows, columns, false);
+}
+
+void falk::lib::spectral::inverse2(std::vector<complex>& data, size_t rows,
+                                   size_t columns) {
+    transform2(data, rows, columns, true);
+}
+
+void falk::lib::fft(evaluator& ev, arguments& args) {
+    std::vector<complex> data;
+    if (!sequence_of(ev, args[0], "fft", data)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"fft", data.size(), [&] {
+        return trace::field("n", std::to_string(data.size()));
+    }};
+
+    spectral::forward(data);
+    ev.push(array_of(data.data(), data.size()));
+}
+
+void falk::lib::ifft(evaluator& ev, arguments& args) {
+    std::vector<complex> data;
+    if (!sequence_of(ev, args[0], "ifft", data)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"ifft", data.size(), [&] {
+        return trace::field("n", std::to_string(data.size()));
+    }};
+
+    spectral::inverse(data);
+    ev.push(array_of(data.data(), data.size()));
+}
+
+void falk::lib::rfft(evaluator& ev, arguments& args) {
+    std::vector<complex> data;
+    if (!sequence_of(ev, args[0], "rfft", data)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"rfft", data.size(), [&] {
+        return trace::field("n", std::to_string(data.size()));
+    }};
+
+    for (auto& value : data) {
+        if (value.imag() != 0) {
+            err::semantic<Error::INVALID_ARGUMENT>("rfft",
+                "expected an array of real numbers");
+            ev.push(array(true));
+            return;
+        }
+    }
+
+    auto n = data.size();
+    if (n == 0) {
+        ev.push(array());
+        return;
+    }
+
+    if (n % 2 != 0) {
+        spectral::forward(data);
+        ev.push(array_of(data.data(), n / 2 + 1));
+        return;
+    }
+
+    // the even and odd elements are transformed at once, as the real
+    // and imaginary parts of a sequence of half the size
+    auto h = n / 2;
+    std::vector<complex> packed(h);
+    for (size_t k = 0; k < h; k++) {
+        packed[k] = {data[2 * k].real(), data[2 * k + 1].real()};
+    }
+    spectral::forward(packed);
+
+    std::vector<complex> result(h + 1);
+    for (size_t k = 0; k <= h; k++) {
+        auto z = packed[k % h];
+        auto mirrored = std::conj(packed[(h - k) % h]);
+        auto even = 0.5 * (z + mirrored);
+        auto odd = complex(0, -0.5) * (z - mirrored);
+        result[k] = even + unit(k, n) * odd;
+    }
+    ev.push(array_of(result.data(), h + 1));
+}
+
+void falk::lib::fft2(evaluator& ev, arguments& args) {
+    transform_matrix(ev, args, "fft2", false);
+}
+
+void falk::lib::ifft2(evaluator& ev, arguments& args) {
+    transform_matrix(ev, args, "ifft2", true);
+}
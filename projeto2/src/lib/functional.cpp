@@ -0,0 +1,234 @@
+#include "base/evaluator.hpp"
+#include "lib/arguments.hpp"
+#include "lib/functional.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+
+    // Calls a user function with a single argument, expecting a scalar.
+    bool apply(evaluator& ev, const std::string& fn, const std::string& name,
+               std::vector<variable>& args, scalar& result) {
+        auto value = ev.invoke(name, args);
+        if (value.error()) {
+            return false;
+        }
+
+        if (value.stored_type() != S::SCALAR) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "the function must return a scalar");
+            return false;
+        }
+        result = value.value<scalar>();
+        return true;
+    }
+
+    bool map_array(evaluator& ev, const std::string& name, const array& in,
+                   array& out) {
+        std::vector<variable> args(1);
+        scalar value;
+        out.reserve(in.size());
+        for (auto element : in) {
+            args[0] = element;
+            if (!apply(ev, "map", name, args, value)) {
+                return false;
+            }
+            out.push_back(value);
+        }
+        return true;
+    }
+}
+
+void falk::lib::map(evaluator& ev, arguments& args) {
+    std::string name;
+    if (!function_of(ev, args[0], "map", name)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    auto value = ev.evaluate(args[1]);
+    if (value.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    switch (value.stored_type()) {
+        case S::ARRAY: {
+            array result;
+            if (map_array(ev, name, value.value<array>(), result)) {
+                ev.push(result);
+                return;
+            }
+            break;
+        }
+        case S::MATRIX: {
+            auto& m = value.value<matrix>();
+            matrix result;
+            result.reserve(m.row_count(), m.column_count());
+            bool ok = true;
+            for (size_t i = 0; ok && i < m.row_count(); i++) {
+                array row;
+                ok = map_array(ev, name, m.row(i), row);
+                result.push_back(row);
+            }
+            if (ok) {
+                ev.push(result);
+                return;
+            }
+            break;
+        }
+        default:
+            err::semantic<Error::INVALID_ARGUMENT>("map",
+                "expected an array or matrix");
+    }
+    ev.push(scalar::invalid());
+}
+
+void falk::lib::map_rows(evaluator& ev, arguments& args) {
+    std::string name;
+    if (!function_of(ev, args[0], "map_rows", name)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    auto value = ev.evaluate(args[1]);
+    if (value.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    if (value.stored_type() != S::MATRIX) {
+        err::semantic<Error::INVALID_ARGUMENT>("map_rows",
+            "expected a matrix");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    // the type of the first result decides the shape of the others
+    auto& m = value.value<matrix>();
+    std::vector<variable> call(1);
+    array scalars;
+    matrix rows;
+    auto shape = S::SCALAR;
+    for (size_t i = 0; i < m.row_count(); i++) {
+        call[0] = m.row(i);
+        auto result = ev.invoke(name, call);
+        if (result.error()) {
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (i == 0) {
+            shape = result.stored_type();
+            if (shape == S::SCALAR) {
+                scalars.reserve(m.row_count());
+            } else if (shape == S::ARRAY) {
+                rows.reserve(m.row_count(), result.value<array>().size());
+            }
+        }
+
+        auto type = result.stored_type();
+        if (type == S::SCALAR && shape == S::SCALAR) {
+            scalars.push_back(result.value<scalar>());
+        } else if (type == S::ARRAY && shape == S::ARRAY
+                   && (i == 0 || result.value<array>().size()
+                                 == rows.column_count())) {
+            rows.push_back(result.value<array>());
+        } else {
+            err::semantic<Error::INVALID_ARGUMENT>("map_rows",
+                "the function must return scalars or arrays of one size");
+            ev.push(scalar::invalid());
+            return;
+        }
+    }
+
+    if (shape == S::ARRAY) {
+        ev.push(rows);
+    } else {
+        ev.push(scalars);
+    }
+}
+
+void falk::lib::reduce(evaluator& ev, arguments& args) {
+    std::string name;
+    if (!function_of(ev, args[0], "reduce", name)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    auto value = ev.evaluate(args[1]);
+    auto accumulator = ev.evaluate(args[2]);
+    if (value.error() || accumulator.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    std::vector<variable> call(2);
+    auto step = [&](variable element) {
+        call[0] = std::move(accumulator);
+        call[1] = std::move(element);
+        accumulator = ev.invoke(name, call);
+        return !accumulator.error();
+    };
+
+    switch (value.stored_type()) {
+        case S::ARRAY: {
+            const auto& elements = value.value<array>();
+            for (auto element : elements) {
+                if (!step(element)) {
+                    ev.push(scalar::invalid());
+                    return;
+                }
+            }
+            break;
+        }
+        case S::MATRIX: {
+            auto& m = value.value<matrix>();
+            for (size_t i = 0; i < m.row_count(); i++) {
+                if (!step(m.row(i))) {
+                    ev.push(scalar::invalid());
+                    return;
+                }
+            }
+            break;
+        }
+        default:
+            err::semantic<Error::INVALID_ARGUMENT>("reduce",
+                "expected an array or matrix");
+            ev.push(scalar::invalid());
+            return;
+    }
+    ev.push(accumulator);
+}
+
+void falk::lib::filter(evaluator& ev, arguments& args) {
+    std::string name;
+    array values;
+    if (!function_of(ev, args[0], "filter", name)
+        || !array_of(ev, args[1], "filter", values)) {
+        ev.push(array(true));
+        return;
+    }
+
+    std::vector<variable> call(1);
+    scalar keep;
+    array result;
+    result.reserve(values.size());
+    const array& elements = values;
+    for (auto element : elements) {
+        call[0] = element;
+        if (!apply(ev, "filter", name, call, keep)) {
+            ev.push(array(true));
+            return;
+        }
+        if (keep.boolean()) {
+            result.push_back(element);
+        }
+    }
+    ev.push(result);
+}
@@ -0,0 +1,418 @@
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "base/evaluator.hpp"
+#include "lib/arguments.hpp"
+#include "lib/integration.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+
+    constexpr double EPSILON = std::numeric_limits<double>::epsilon();
+    // subintervals of quad and steps of ode_rk45 before giving up
+    constexpr size_t MAX_INTERVALS = 10000;
+    constexpr size_t MAX_STEPS = 100000;
+
+    // Kronrod nodes (the odd ones are also Gauss nodes) and weights,
+    // from the outermost to the center
+    constexpr double KRONROD_NODES[] = {
+        0.991455371120812639206854697526329,
+        0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926,
+        0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013,
+        0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245,
+        0.000000000000000000000000000000000,
+    };
+    constexpr double KRONROD_WEIGHTS[] = {
+        0.022935322010529224963732008058970,
+        0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518,
+        0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550,
+        0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649,
+        0.209482141084727828012999174891714,
+    };
+    constexpr double GAUSS_WEIGHTS[] = {
+        0.129484966168869693270611432679082,
+        0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975,
+        0.417959183673469387755102040816327,
+    };
+
+    // Calls a user function with real arguments, expecting a real
+    // result (a scalar or an array of the given size).
+    class callback {
+     public:
+        callback(evaluator& ev, std::string fn, std::string name):
+          ev(ev), fn{std::move(fn)}, name{std::move(name)} { }
+
+        bool operator()(std::vector<variable>& args, std::vector<double>& result,
+                        bool scalar_result) {
+            auto value = ev.invoke(name, args);
+            if (value.error()) {
+                return false;
+            }
+
+            auto n = result.size();
+            if (scalar_result && value.stored_type() == S::SCALAR) {
+                return store(value.value<scalar>(), result[0]);
+            }
+
+            if (!scalar_result && value.stored_type() == S::ARRAY
+                && value.value<array>().size() == n) {
+                auto& values = value.value<array>();
+                for (size_t i = 0; i < n; i++) {
+                    if (!store(values.unchecked(i), result[i])) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            err::semantic<Error::INVALID_ARGUMENT>(fn, scalar_result
+                ? "the function must return a scalar"
+                : "the function must return an array of the size of y0");
+            return false;
+        }
+
+     private:
+        evaluator& ev;
+        std::string fn;
+        std::string name;
+
+        bool store(const scalar& value, double& target) {
+            if (value.inner_type() == falk::type::COMPLEX) {
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "not defined for complex numbers");
+                return false;
+            }
+            target = value.real();
+            return true;
+        }
+    };
+
+    struct interval {
+        double a;
+        double b;
+        double value;
+        double error;
+
+        bool operator<(const interval& other) const {
+            return error < other.error;
+        }
+    };
+
+    bool kronrod(callback& f, double a, double b, interval& result) {
+        auto center = (a + b) / 2;
+        auto half = (b - a) / 2;
+        std::vector<variable> args(1);
+        std::vector<double> value(1);
+        double gauss = 0, sum = 0;
+        for (size_t i = 0; i < 8; i++) {
+            double total = 0;
+            auto points = i < 7 ? 2 : 1;
+            for (auto sign : {-1, 1}) {
+                if (points-- == 0) {
+                    break;
+                }
+                args[0] = scalar(center + sign * half * KRONROD_NODES[i]);
+                if (!f(args, value, true)) {
+                    return false;
+                }
+                total += value[0];
+            }
+            sum += KRONROD_WEIGHTS[i] * total;
+            if (i % 2 == 1) {
+                gauss += GAUSS_WEIGHTS[i / 2] * total;
+            }
+        }
+
+        result = {a, b, sum * half, std::fabs((sum - gauss) * half)};
+        return true;
+    }
+
+    bool real_of(evaluator& ev, const falk::builtins::node_ptr& node,
+                 const std::string& fn, double& result) {
+        scalar value;
+        if (!scalar_of(ev, node, fn, value)) {
+            return false;
+        }
+
+        if (value.inner_type() == falk::type::COMPLEX
+            || !std::isfinite(value.real())) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "expected a finite real number");
+            return false;
+        }
+        result = value.real();
+        return true;
+    }
+
+    // Dormand-Prince coefficients: nodes, stages (the last one gives
+    // the solution) and the difference between the 5th and 4th order
+    // solutions
+    constexpr double C[] = {0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1};
+    constexpr double A[7][6] = {
+        {},
+        {1.0 / 5},
+        {3.0 / 40, 9.0 / 40},
+        {44.0 / 45, -56.0 / 15, 32.0 / 9},
+        {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+        {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176,
+         -5103.0 / 18656},
+        {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784,
+         11.0 / 84},
+    };
+    constexpr double E[] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920,
+                            -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+    // The derivative function of ode_rk45, with the stage buffers.
+    class dynamics {
+     public:
+        dynamics(callback f, size_t n, bool scalar_state):
+          f(std::move(f)), n{n}, scalar_state{scalar_state},
+          stages(7, std::vector<double>(n)), args(2) {
+            if (!scalar_state) {
+                state.reserve(n);
+            }
+        }
+
+        // y' at (t, y), into a stage buffer
+        bool derivative(double t, const std::vector<double>& y, size_t stage) {
+            args[0] = scalar(t);
+            if (scalar_state) {
+                args[1] = scalar(y[0]);
+            } else {
+                state = array();
+                state.reserve(n);
+                for (auto value : y) {
+                    state.push_back(scalar(value));
+                }
+                args[1] = state;
+            }
+            return f(args, stages[stage], scalar_state);
+        }
+
+        // one step from (t, y), into next; returns the scaled error
+        // norm, or a negative number on errors
+        double step(double t, double h, const std::vector<double>& y,
+                    std::vector<double>& next, double rtol, double atol) {
+            for (size_t s = 1; s < 7; s++) {
+                for (size_t i = 0; i < n; i++) {
+                    double sum = 0;
+                    for (size_t j = 0; j < s; j++) {
+                        sum += A[s][j] * stages[j][i];
+                    }
+                    next[i] = y[i] + h * sum;
+                }
+                if (!derivative(t + C[s] * h, next, s)) {
+                    return -1;
+                }
+            }
+
+            double norm = 0;
+            for (size_t i = 0; i < n; i++) {
+                double error = 0;
+                for (size_t s = 0; s < 7; s++) {
+                    error += E[s] * stages[s][i];
+                }
+                auto scale = atol + rtol * std::max(std::fabs(y[i]),
+                                                    std::fabs(next[i]));
+                norm += std::pow(h * error / scale, 2);
+            }
+            return n ? std::sqrt(norm / n) : 0;
+        }
+
+        // the last stage is the derivative at the end of the step, the
+        // first of the next one
+        void advance() {
+            std::swap(stages[0], stages[6]);
+        }
+
+        const std::vector<double>& first() const {
+            return stages[0];
+        }
+
+     private:
+        callback f;
+        size_t n;
+        bool scalar_state;
+        std::vector<std::vector<double>> stages;
+        std::vector<variable> args;
+        array state;
+    };
+
+    array row_of(double t, const std::vector<double>& y) {
+        array row;
+        row.reserve(y.size() + 1);
+        row.push_back(scalar(t));
+        for (auto value : y) {
+            row.push_back(scalar(value));
+        }
+        return row;
+    }
+}
+
+void falk::lib::quad(evaluator& ev, arguments& args) {
+    std::string name;
+    double a, b, tol = 1e-10;
+    if (!function_of(ev, args[0], "quad", name)
+        || !real_of(ev, args[1], "quad", a)
+        || !real_of(ev, args[2], "quad", b)
+        || (args.size() > 3 && !real_of(ev, args[3], "quad", tol))) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    callback f(ev, "quad", name);
+    interval first;
+    if (!kronrod(f, a, b, first)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    std::priority_queue<interval> intervals;
+    intervals.push(first);
+    auto value = first.value;
+    auto error = first.error;
+    while (error > std::max(tol, tol * std::fabs(value))) {
+        if (intervals.size() >= MAX_INTERVALS) {
+            err::semantic<Error::INVALID_ARGUMENT>("quad",
+                "the integral did not converge");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        auto worst = intervals.top();
+        intervals.pop();
+        auto middle = (worst.a + worst.b) / 2;
+        interval left, right;
+        if (!kronrod(f, worst.a, middle, left)
+            || !kronrod(f, middle, worst.b, right)) {
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        value += left.value + right.value - worst.value;
+        error += left.error + right.error - worst.error;
+        intervals.push(left);
+        intervals.push(right);
+    }
+
+    // summed again, as the updates accumulate rounding errors
+    value = 0;
+    for (; !intervals.empty(); intervals.pop()) {
+        value += intervals.top().value;
+    }
+    ev.push(scalar(value));
+}
+
+void falk::lib::ode_rk45(evaluator& ev, arguments& args) {
+    std::string name;
+    double t0, t1, rtol = 1e-6, atol = 1e-9;
+    if (!function_of(ev, args[0], "ode_rk45", name)) {
+        ev.push(matrix(true));
+        return;
+    }
+
+    auto initial = ev.evaluate(args[1]);
+    if (initial.error()) {
+        ev.push(matrix(true));
+        return;
+    }
+
+    std::vector<double> y;
+    bool scalar_state = initial.stored_type() == S::SCALAR;
+    if (scalar_state) {
+        y.push_back(initial.value<scalar>().real());
+    } else if (initial.stored_type() == S::ARRAY
+               && initial.value<array>().inner_type() != falk::type::COMPLEX) {
+        const auto& values = initial.value<array>();
+        for (auto value : values) {
+            y.push_back(value.real());
+        }
+    } else {
+        err::semantic<Error::INVALID_ARGUMENT>("ode_rk45",
+            "expected a real scalar or array as initial value");
+        ev.push(matrix(true));
+        return;
+    }
+
+    if (!real_of(ev, args[2], "ode_rk45", t0)
+        || !real_of(ev, args[3], "ode_rk45", t1)
+        || (args.size() > 4 && !real_of(ev, args[4], "ode_rk45", rtol))
+        || (args.size() > 5 && !real_of(ev, args[5], "ode_rk45", atol))) {
+        ev.push(matrix(true));
+        return;
+    }
+
+    auto n = y.size();
+    dynamics sys(callback(ev, "ode_rk45", name), n, scalar_state);
+    matrix trajectory;
+    trajectory.push_back(row_of(t0, y));
+    if (t0 == t1) {
+        ev.push(trajectory);
+        return;
+    }
+
+    if (!sys.derivative(t0, y, 0)) {
+        ev.push(matrix(true));
+        return;
+    }
+
+    // initial step from the scales of y and y' (Hairer et al.)
+    double d0 = 0, d1 = 0;
+    for (size_t i = 0; i < n; i++) {
+        auto scale = atol + rtol * std::fabs(y[i]);
+        d0 += std::pow(y[i] / scale, 2);
+        d1 += std::pow(sys.first()[i] / scale, 2);
+    }
+    d0 = n ? std::sqrt(d0 / n) : 0;
+    d1 = n ? std::sqrt(d1 / n) : 0;
+    auto span = std::fabs(t1 - t0);
+    auto h = std::min(span, d0 < 1e-5 || d1 < 1e-5 ? 1e-6 : 0.01 * d0 / d1);
+    auto direction = t1 > t0 ? 1.0 : -1.0;
+
+    auto t = t0;
+    std::vector<double> next(n);
+    for (size_t steps = 0; t != t1; steps++) {
+        if (steps == MAX_STEPS || h < 16 * EPSILON * std::fabs(t)) {
+            err::semantic<Error::INVALID_ARGUMENT>("ode_rk45",
+                steps == MAX_STEPS ? "too many steps" : "step size too small");
+            ev.push(matrix(true));
+            return;
+        }
+
+        auto last = h >= std::fabs(t1 - t);
+        if (last) {
+            h = std::fabs(t1 - t);
+        }
+
+        auto error = sys.step(t, direction * h, y, next, rtol, atol);
+        if (error < 0) {
+            ev.push(matrix(true));
+            return;
+        }
+
+        if (error <= 1) {
+            t = last ? t1 : t + direction * h;
+            y.swap(next);
+            sys.advance();
+            trajectory.push_back(row_of(t, y));
+        }
+
+        auto factor = error == 0 ? 5 : 0.9 * std::pow(error, -0.2);
+        h *= std::min(5.0, std::max(0.2, factor));
+    }
+    ev.push(trajectory);
+}
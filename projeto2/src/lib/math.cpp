@@ -0,0 +1,406 @@
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/math.hpp"
+#include "lib/parallel.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+    namespace trace = falk::trace;
+
+    bool strict = false;
+
+    double from_bits(uint64_t bits) {
+        double result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    uint64_t to_bits(double value) {
+        uint64_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    // The kernels below evaluate a whole buffer with branch-free code,
+    // then fix the elements out of their domain, so that the first loop
+    // can be vectorized.
+    namespace kernels {
+        constexpr double LN2_HI = 6.93147180369123816490e-01;
+        constexpr double LN2_LO = 1.90821492927058770002e-10;
+        constexpr double LOG2_E = 1.44269504088896338700e+00;
+        constexpr double SQRT_2 = 1.41421356237309504880e+00;
+        constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+        // pi/2 split in three parts, each product by an integer up to
+        // 2^20 being exact
+        constexpr double PIO2_1 = 1.57079632673412561417e+00;
+        constexpr double PIO2_2 = 6.07710050630396597660e-11;
+        constexpr double PIO2_3 = 2.02226624871116645580e-21;
+        constexpr double TRIG_LIMIT = 1e5;
+        constexpr double EXP_LIMIT = 708;
+
+        // exp(x) = 2^k * exp(r), with |r| <= ln(2)/2 and exp(r) by its
+        // Taylor polynomial of degree 13
+        void exp(const double* in, double* out, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                auto x = std::fmin(std::fmax(in[i], -EXP_LIMIT), EXP_LIMIT);
+                auto k = std::nearbyint(x * LOG2_E);
+                auto r = (x - k * LN2_HI) - k * LN2_LO;
+                auto p = 1.0 / 6227020800;
+                p = p * r + 1.0 / 479001600;
+                p = p * r + 1.0 / 39916800;
+                p = p * r + 1.0 / 3628800;
+                p = p * r + 1.0 / 362880;
+                p = p * r + 1.0 / 40320;
+                p = p * r + 1.0 / 5040;
+                p = p * r + 1.0 / 720;
+                p = p * r + 1.0 / 120;
+                p = p * r + 1.0 / 24;
+                p = p * r + 1.0 / 6;
+                p = p * r + 0.5;
+                p = p * r * r + r;
+                auto scale = from_bits(uint64_t(int64_t(k) + 1023) << 52);
+                out[i] = (1 + p) * scale;
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                if (!(std::fabs(in[i]) <= EXP_LIMIT)) {
+                    out[i] = std::exp(in[i]);
+                }
+            }
+        }
+
+        // log(x) = e * ln(2) + log(m), with x = 2^e * m and
+        // sqrt(2)/2 <= m < sqrt(2); log(m) = 2 * atanh(s), where
+        // s = (m - 1) / (m + 1), by its series up to s^23
+        void log(const double* in, double* out, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                auto bits = to_bits(in[i]);
+                auto e = double(int64_t((bits >> 52) & 0x7FF) - 1023);
+                auto m = from_bits((bits & 0x000FFFFFFFFFFFFF)
+                                   | 0x3FF0000000000000);
+                auto big = m > SQRT_2;
+                m = big ? m * 0.5 : m;
+                e = big ? e + 1 : e;
+
+                auto f = m - 1;
+                auto s = f / (2 + f);
+                auto z = s * s;
+                auto p = 1.0 / 23;
+                p = p * z + 1.0 / 21;
+                p = p * z + 1.0 / 19;
+                p = p * z + 1.0 / 17;
+                p = p * z + 1.0 / 15;
+                p = p * z + 1.0 / 13;
+                p = p * z + 1.0 / 11;
+                p = p * z + 1.0 / 9;
+                p = p * z + 1.0 / 7;
+                p = p * z + 1.0 / 5;
+                p = p * z + 1.0 / 3;
+                // log(m) = f - (f^2/2 - s * (f^2/2 + R)), which keeps
+                // most of the result in the exact f
+                auto R = 2 * z * p;
+                auto hf = 0.5 * f * f;
+                out[i] = e * LN2_HI
+                       - ((hf - (s * (hf + R) + e * LN2_LO)) - f);
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                if (!std::isnormal(in[i]) || in[i] < 0) {
+                    out[i] = std::log(in[i]);
+                }
+            }
+        }
+
+        double sin_poly(double r) {
+            auto z = r * r;
+            auto p = -1.0 / 355687428096000;
+            p = p * z + 1.0 / 1307674368000;
+            p = p * z - 1.0 / 6227020800;
+            p = p * z + 1.0 / 39916800;
+            p = p * z - 1.0 / 362880;
+            p = p * z + 1.0 / 5040;
+            p = p * z - 1.0 / 120;
+            p = p * z + 1.0 / 6;
+            return r - r * z * p;
+        }
+
+        double cos_poly(double r) {
+            auto z = r * r;
+            auto p = 1.0 / 6402373705728000;
+            p = p * z - 1.0 / 20922789888000;
+            p = p * z + 1.0 / 87178291200;
+            p = p * z - 1.0 / 479001600;
+            p = p * z + 1.0 / 3628800;
+            p = p * z - 1.0 / 40320;
+            p = p * z + 1.0 / 720;
+            p = p * z - 1.0 / 24;
+            // 1 - z/2 is rounded once, and its error added back
+            auto h = 0.5 * z;
+            auto w = 1 - h;
+            return w + (((1 - w) - h) - z * z * p);
+        }
+
+        // sin(x) and cos(x) from r = x - k * pi/2 (|r| <= pi/4) and the
+        // quadrant k mod 4; offset 1 turns sin into cos
+        void trig(const double* in, double* out, size_t n, int offset) {
+            for (size_t i = 0; i < n; i++) {
+                auto x = std::fmin(std::fmax(in[i], -TRIG_LIMIT), TRIG_LIMIT);
+                auto k = std::nearbyint(x * TWO_OVER_PI);
+                auto r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+                auto quadrant = (int64_t(k) + offset) & 3;
+                auto value = (quadrant & 1) ? cos_poly(r) : sin_poly(r);
+                out[i] = (quadrant & 2) ? -value : value;
+            }
+
+            // results close to 0 (besides sin(x) for a small x) lose
+            // the precision of the reduction by cancellation, and the
+            // sign of sin(-0) is lost
+            for (size_t i = 0; i < n; i++) {
+                auto x = std::fabs(in[i]);
+                if (!(x <= TRIG_LIMIT) || x == 0
+                    || (std::fabs(out[i]) < 1e-5 && x > 1e-5)) {
+                    out[i] = offset ? std::cos(in[i]) : std::sin(in[i]);
+                }
+            }
+        }
+
+        void sin(const double* in, double* out, size_t n) {
+            trig(in, out, n, 0);
+        }
+
+        void cos(const double* in, double* out, size_t n) {
+            trig(in, out, n, 1);
+        }
+    }
+}
+
+namespace {
+    using kernel = void (*)(const double*, double*, size_t);
+    using real_function = double (*)(double);
+    using complex_function = std::complex<double> (*)(std::complex<double>);
+    using transform = bool (*)(const array&, array&);
+
+    // Applies a kernel to a buffer, split among threads if it is large.
+    void run(kernel k, const std::vector<double>& in, std::vector<double>& out) {
+        auto n = in.size();
+        auto count = workers(n);
+        parallel(count, [&](size_t t) {
+            auto begin = n * t / count;
+            auto end = n * (t + 1) / count;
+            k(in.data() + begin, out.data() + begin, end - begin);
+        });
+    }
+
+    // Applies a function to the elements of an array: reals through the
+    // kernel (if any, and unless in strict mode), complex numbers
+    // through the standard library.
+    void elementary(const array& in, array& out, kernel fast,
+                    real_function precise, complex_function complex) {
+        auto n = in.size();
+        out.reserve(n);
+        if (in.inner_type() == falk::type::COMPLEX) {
+            std::vector<std::complex<double>> values(n);
+            parallel_for(n, [&](size_t i) {
+                auto value = in.unchecked(i);
+                values[i] = complex({value.real(), value.imag()});
+            });
+            for (auto& value : values) {
+                out.push_back(scalar(value));
+            }
+            return;
+        }
+
+        std::vector<double> values(n), results(n);
+        for (size_t i = 0; i < n; i++) {
+            values[i] = in.unchecked(i).real();
+        }
+
+        if (fast && !strict) {
+            run(fast, values, results);
+        } else {
+            parallel_for(n, [&](size_t i) {
+                results[i] = precise(values[i]);
+            });
+        }
+
+        for (auto result : results) {
+            out.push_back(scalar(result));
+        }
+    }
+
+    // Applies a transform to the elements of the only argument,
+    // keeping its shape.
+    void apply(evaluator& ev, arguments& args, const std::string& fn,
+               transform f) {
+        auto value = ev.evaluate(args[0]);
+        if (value.error()) {
+            ev.push(scalar::invalid());
+            return;
+        }
+        trace::span traced{fn, trace::elements(value), [&] {
+            return trace::field("x", trace::shape(value));
+        }};
+
+        switch (value.stored_type()) {
+            case S::SCALAR: {
+                array single, result;
+                single.push_back(value.value<scalar>());
+                if (f(single, result)) {
+                    ev.push(result[0]);
+                    return;
+                }
+                break;
+            }
+            case S::ARRAY: {
+                array result;
+                if (f(value.value<array>(), result)) {
+                    ev.push(result);
+                    return;
+                }
+                break;
+            }
+            case S::MATRIX: {
+                // elements are transformed at once, in row-major order
+                auto& m = value.value<matrix>();
+                array elements, result;
+                elements.reserve(m.row_count() * m.column_count());
+                for (size_t i = 0; i < m.row_count(); i++) {
+                    elements.extend(m.row(i));
+                }
+
+                if (f(elements, result)) {
+                    matrix rows;
+                    rows.reserve(m.row_count(), m.column_count());
+                    for (size_t i = 0; i < m.row_count(); i++) {
+                        array row;
+                        row.reserve(m.column_count());
+                        for (size_t j = 0; j < m.column_count(); j++) {
+                            row.push_back(result[i * m.column_count() + j]);
+                        }
+                        rows.push_back(row);
+                    }
+                    ev.push(rows);
+                    return;
+                }
+                break;
+            }
+            default:
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "expected a scalar, array or matrix");
+        }
+        ev.push(scalar::invalid());
+    }
+
+    bool magnitude(const array& in, array& out) {
+        out.reserve(in.size());
+        for (auto value : in) {
+            if (value.inner_type() == falk::type::INT) {
+                // the smallest integer has no positive counterpart, so it
+                // becomes a real, as negation does
+                auto x = value.integer();
+                if (x == INT64_MIN) {
+                    out.push_back(scalar(-value.real()));
+                } else {
+                    out.push_back(scalar(x < 0 ? -x : x));
+                }
+            } else {
+                out.push_back(scalar(std::abs(std::complex<double>(
+                    value.real(), value.imag()))));
+            }
+        }
+        return true;
+    }
+
+    bool round_down(const array& in, array& out) {
+        if (in.inner_type() == falk::type::COMPLEX) {
+            err::semantic<Error::INVALID_ARGUMENT>("floor",
+                "not defined for complex numbers");
+            return false;
+        }
+
+        out.reserve(in.size());
+        for (auto value : in) {
+            if (value.inner_type() == falk::type::INT) {
+                out.push_back(value);
+            } else {
+                out.push_back(scalar(std::floor(value.real())));
+            }
+        }
+        return true;
+    }
+}
+
+void falk::lib::exp(evaluator& ev, arguments& args) {
+    apply(ev, args, "exp", [](const array& in, array& out) {
+        elementary(in, out, kernels::exp,
+            [](double x) { return std::exp(x); },
+            [](std::complex<double> z) { return std::exp(z); });
+        return true;
+    });
+}
+
+void falk::lib::log(evaluator& ev, arguments& args) {
+    apply(ev, args, "log", [](const array& in, array& out) {
+        elementary(in, out, kernels::log,
+            [](double x) { return std::log(x); },
+            [](std::complex<double> z) { return std::log(z); });
+        return true;
+    });
+}
+
+void falk::lib::sin(evaluator& ev, arguments& args) {
+    apply(ev, args, "sin", [](const array& in, array& out) {
+        elementary(in, out, kernels::sin,
+            [](double x) { return std::sin(x); },
+            [](std::complex<double> z) { return std::sin(z); });
+        return true;
+    });
+}
+
+void falk::lib::cos(evaluator& ev, arguments& args) {
+    apply(ev, args, "cos", [](const array& in, array& out) {
+        elementary(in, out, kernels::cos,
+            [](double x) { return std::cos(x); },
+            [](std::complex<double> z) { return std::cos(z); });
+        return true;
+    });
+}
+
+void falk::lib::sqrt(evaluator& ev, arguments& args) {
+    // correctly rounded by the hardware, there is no faster kernel
+    apply(ev, args, "sqrt", [](const array& in, array& out) {
+        elementary(in, out, nullptr,
+            [](double x) { return std::sqrt(x); },
+            [](std::complex<double> z) { return std::sqrt(z); });
+        return true;
+    });
+}
+
+void falk::lib::abs(evaluator& ev, arguments& args) {
+    apply(ev, args, "abs", magnitude);
+}
+
+void falk::lib::floor(evaluator& ev, arguments& args) {
+    apply(ev, args, "floor", round_down);
+}
+
+void falk::lib::strict_math(evaluator& ev, arguments& args) {
+    bool flag;
+    if (!flag_of(ev, args, 0, "strict_math", flag)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    strict = flag;
+    ev.push(scalar::silent());
+}
@@ -0,0 +1,220 @@
+#include <cmath>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/parallel.hpp"
+#include "lib/random.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using namespace falk::lib;
+    namespace trace = falk::trace;
+
+    constexpr uint64_t GAMMA = 0x9e3779b97f4a7c15;
+    constexpr double TWO_PI = 6.28318530717958647692;
+    // elements are addressed by 32-bit positions in the sorting and set
+    // builtins, so larger structures could not be used anyway
+    constexpr size_t MAX_ELEMENTS = UINT32_MAX;
+
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+    // SplitMix64, whose k-th output depends only on the seed and k
+    class stream {
+     public:
+        void restart(uint64_t seed) {
+            key = mix(seed);
+            position = 0;
+        }
+
+        uint64_t bits(uint64_t k) const {
+            return mix(key + (position + k + 1) * GAMMA);
+        }
+
+        double uniform(uint64_t k) const {
+            return (bits(k) >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        void advance(uint64_t count) {
+            position += count;
+        }
+
+     private:
+        uint64_t key = mix(0);
+        uint64_t position = 0;
+    } global;
+
+    // Shape given by the size arguments from a position on: a scalar,
+    // an array of n elements or a matrix of r x c elements.
+    struct shape {
+        size_t arguments = 0;
+        size_t rows = 1;
+        size_t columns = 1;
+
+        size_t count() const {
+            return rows * columns;
+        }
+
+        // as given by trace::shape()
+        std::string text() const {
+            switch (arguments) {
+                case 0:
+                    return "scalar";
+                case 1:
+                    return "array[" + std::to_string(columns) + "]";
+            }
+            return "matrix[" + std::to_string(rows) + ", "
+                 + std::to_string(columns) + "]";
+        }
+    };
+
+    bool shape_of(evaluator& ev, arguments& args, size_t position,
+                  const std::string& fn, shape& result) {
+        size_t sizes[2];
+        result.arguments = args.size() - position;
+        for (size_t i = 0; i < result.arguments; i++) {
+            scalar size;
+            if (!scalar_of(ev, args[position + i], fn, size)) {
+                return false;
+            }
+
+            if (size.integer() < 0) {
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "sizes must be non-negative");
+                return false;
+            }
+            sizes[i] = size.integer();
+        }
+
+        size_t count = 1;
+        for (size_t i = 0; i < result.arguments; i++) {
+            if (__builtin_mul_overflow(count, sizes[i], &count)
+                || count > MAX_ELEMENTS) {
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "too many elements");
+                return false;
+            }
+        }
+
+        if (result.arguments == 1) {
+            result.columns = sizes[0];
+        } else if (result.arguments == 2) {
+            result.rows = sizes[0];
+            result.columns = sizes[1];
+        }
+        return true;
+    }
+
+    // Fills a structure of the given shape with draw(k), for k in
+    // [0, count), then moves the stream past the numbers used. Draws have
+    // the structure's type, so set() never changes its storage and the
+    // workers can write concurrently.
+    template<typename F>
+    void fill(evaluator& ev, const std::string& fn, const shape& s,
+              falk::type type, uint64_t consumed, F&& draw) {
+        trace::span traced{fn, s.count(), [&] {
+            return trace::field("shape", s.text());
+        }};
+        switch (s.arguments) {
+            case 0:
+                ev.push(draw(0));
+                break;
+            case 1: {
+                array result(scalar(int64_t(s.count())), type);
+                parallel_for(s.count(), [&](size_t k) {
+                    result.set(k, draw(k));
+                });
+                ev.push(result);
+                break;
+            }
+            default: {
+                matrix result(scalar(int64_t(s.rows)),
+                              scalar(int64_t(s.columns)), type);
+                parallel_for(s.count(), [&](size_t k) {
+                    result.set(k / s.columns, k % s.columns, draw(k));
+                });
+                ev.push(result);
+            }
+        }
+        global.advance(consumed);
+    }
+}
+
+void falk::lib::seed(evaluator& ev, arguments& args) {
+    scalar value;
+    if (!scalar_of(ev, args[0], "seed", value)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    global.restart(value.integer());
+    ev.push(scalar::silent());
+}
+
+void falk::lib::rand(evaluator& ev, arguments& args) {
+    shape s;
+    if (!shape_of(ev, args, 0, "rand", s)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    fill(ev, "rand", s, type::REAL, s.count(), [](uint64_t k) {
+        return scalar(global.uniform(k));
+    });
+}
+
+void falk::lib::randn(evaluator& ev, arguments& args) {
+    shape s;
+    if (!shape_of(ev, args, 0, "randn", s)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    // Box-Muller: each pair of elements comes from a pair of uniform
+    // numbers
+    auto pairs = (s.count() + 1) / 2;
+    fill(ev, "randn", s, type::REAL, 2 * pairs, [](uint64_t k) {
+        auto pair = k / 2;
+        auto radius = std::sqrt(-2 * std::log(1 - global.uniform(2 * pair)));
+        auto angle = TWO_PI * global.uniform(2 * pair + 1);
+        return scalar(radius * (k % 2 ? std::sin(angle) : std::cos(angle)));
+    });
+}
+
+void falk::lib::randint(evaluator& ev, arguments& args) {
+    scalar low, high;
+    shape s;
+    if (!scalar_of(ev, args[0], "randint", low)
+        || !scalar_of(ev, args[1], "randint", high)
+        || !shape_of(ev, args, 2, "randint", s)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    auto a = low.integer();
+    auto b = high.integer();
+    if (a > b) {
+        err::semantic<Error::INVALID_ARGUMENT>("randint",
+            "empty interval");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    // scaled by a 128-bit product instead of rejection, so that each
+    // element uses one number (the bias is below 2^-64 per value)
+    uint64_t span = uint64_t(b) - uint64_t(a) + 1;
+    fill(ev, "randint", s, type::INT, s.count(), [&](uint64_t k) {
+        auto bits = global.bits(k);
+        auto offset = span ? uint64_t((__uint128_t(bits) * span) >> 64)
+                           : bits;
+        return scalar(int64_t(uint64_t(a) + offset));
+    });
+}
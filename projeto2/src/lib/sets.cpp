@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <numeric>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/parallel.hpp"
+#include "lib/sets.hpp"
+#include "types/hash_index.hpp"
+#include "types/keys.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::scalar;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+    namespace keys = falk::keys;
+    namespace trace = falk::trace;
+
+    std::vector<uint64_t> hashes(const array& values) {
+        std::vector<uint64_t> result(values.size());
+        parallel_for(values.size(), [&](size_t i) {
+            result[i] = keys::hash(values.unchecked(i));
+        });
+        return result;
+    }
+
+    // Distinct elements of an array: position of the first occurrence
+    // of each one and how many times it occurs.
+    struct groups {
+        std::vector<uint32_t> first;
+        std::vector<int64_t> count;
+    };
+
+    // Groups the elements of an array as they are added.
+    class grouping {
+     public:
+        grouping(const array& values, const std::vector<uint64_t>& hashes)
+        : values(values), hashes(hashes) { }
+
+        void add(size_t i) {
+            auto slot = locate(values.unchecked(i), hashes[i]);
+            if (slot >= 0) {
+                ++result.count[index.position(slot)];
+                return;
+            }
+
+            if (!index.fits()) {
+                index.reset(result.first.size() + 1);
+                for (size_t g = 0; g < result.first.size(); g++) {
+                    index.place(hashes[result.first[g]], g);
+                }
+            }
+            index.place(hashes[i], result.first.size());
+            result.first.push_back(i);
+            result.count.push_back(1);
+        }
+
+        bool contains(const scalar& value, uint64_t hash) const {
+            return locate(value, hash) >= 0;
+        }
+
+        groups& data() {
+            return result;
+        }
+
+     private:
+        const array& values;
+        const std::vector<uint64_t>& hashes;
+        falk::hash_index index;
+        groups result;
+
+        int64_t locate(const scalar& value, uint64_t hash) const {
+            return index.locate(hash, [&](uint32_t g) {
+                return keys::equal(values.unchecked(result.first[g]), value);
+            });
+        }
+    };
+
+    // Groups equal elements by hashing. Large arrays are split in
+    // partitions by hash, each grouped by its own thread, and the groups
+    // are then merged back in order of first occurrence.
+    groups group(const array& values, const std::vector<uint64_t>& h) {
+        auto count = workers(values.size());
+        std::vector<grouping> parts(count, grouping(values, h));
+        parallel(count, [&](size_t t) {
+            for (size_t i = 0; i < values.size(); i++) {
+                // the low and top bits are used by the index itself
+                if ((h[i] >> 32) % count == t) {
+                    parts[t].add(i);
+                }
+            }
+        });
+
+        if (count == 1) {
+            return std::move(parts[0].data());
+        }
+
+        std::vector<std::pair<uint32_t, int64_t>> merged;
+        for (auto& part : parts) {
+            auto& data = part.data();
+            for (size_t g = 0; g < data.first.size(); g++) {
+                merged.emplace_back(data.first[g], data.count[g]);
+            }
+        }
+        std::sort(merged.begin(), merged.end());
+
+        groups result;
+        for (auto& pair : merged) {
+            result.first.push_back(pair.first);
+            result.count.push_back(pair.second);
+        }
+        return result;
+    }
+
+    // Groups equal elements by sorting, in increasing order.
+    groups group_sorted(const array& values) {
+        std::vector<uint32_t> order(values.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](auto l, auto r) {
+            return keys::less(values.unchecked(l), values.unchecked(r));
+        });
+
+        groups result;
+        for (size_t i = 0; i < order.size(); i++) {
+            auto value = values.unchecked(order[i]);
+            if (i > 0 && keys::equal(values.unchecked(order[i - 1]), value)) {
+                ++result.count.back();
+            } else {
+                result.first.push_back(order[i]);
+                result.count.push_back(1);
+            }
+        }
+        return result;
+    }
+
+    array select(const array& values, const std::vector<uint32_t>& positions) {
+        array result;
+        result.reserve(positions.size());
+        for (auto i : positions) {
+            result.push_back(values.unchecked(i));
+        }
+        return result;
+    }
+
+    void distinct(evaluator& ev, const array& values, bool sorted) {
+        auto g = sorted ? group_sorted(values) : group(values, hashes(values));
+        ev.push(select(values, g.first));
+    }
+
+    // Distinct elements of a that are (or are not) in b.
+    void filter(evaluator& ev, falk::lib::arguments& args,
+                const std::string& fn, bool keep) {
+        array a, b;
+        bool sorted;
+        if (!array_of(ev, args[0], fn, a) || !array_of(ev, args[1], fn, b)
+            || !flag_of(ev, args, 2, fn, sorted)) {
+            ev.push(array(true));
+            return;
+        }
+        trace::span traced{fn, a.size() + b.size(), [&] {
+            return trace::field("a", trace::shape(a)) + ", "
+                 + trace::field("b", trace::shape(b));
+        }};
+
+        auto hb = hashes(b);
+        grouping set(b, hb);
+        for (size_t i = 0; i < b.size(); i++) {
+            set.add(i);
+        }
+
+        auto ha = hashes(a);
+        auto g = sorted ? group_sorted(a) : group(a, ha);
+        std::vector<uint32_t> positions;
+        for (auto i : g.first) {
+            if (set.contains(a.unchecked(i), ha[i]) == keep) {
+                positions.push_back(i);
+            }
+        }
+        ev.push(select(a, positions));
+    }
+
+    // ismember(x, b) or 'x in b', whose errors name the operator
+    void membership(evaluator& ev, falk::lib::arguments& args, bool op) {
+        auto invalid = [&](const std::string& extra) {
+            if (op) {
+                err::semantic<Error::INVALID_OPERAND>("in", extra);
+            } else {
+                err::semantic<Error::INVALID_ARGUMENT>("ismember", extra);
+            }
+            ev.push(scalar::invalid());
+        };
+
+        auto x = ev.evaluate(args[0]);
+        if (x.error()) {
+            ev.push(scalar::invalid());
+            return;
+        }
+        auto set_values = ev.evaluate(args[1]);
+        if (set_values.error()) {
+            ev.push(scalar::invalid());
+            return;
+        }
+        if (set_values.stored_type() != S::ARRAY) {
+            invalid("expected an array");
+            return;
+        }
+
+        auto& b = set_values.value<array>();
+        trace::span traced{op ? "in" : "ismember",
+                           trace::elements(x) + b.size(), [&] {
+            return trace::field("x", trace::shape(x)) + ", "
+                 + trace::field("b", trace::shape(b));
+        }};
+
+        auto hb = hashes(b);
+        grouping set(b, hb);
+        for (size_t i = 0; i < b.size(); i++) {
+            set.add(i);
+        }
+
+        switch (x.stored_type()) {
+            case S::SCALAR: {
+                auto& value = x.value<scalar>();
+                ev.push(scalar(set.contains(value, keys::hash(value))));
+                break;
+            }
+            case S::ARRAY: {
+                auto& values = x.value<array>();
+                std::vector<char> found(values.size());
+                parallel_for(values.size(), [&](size_t i) {
+                    auto value = values.unchecked(i);
+                    found[i] = set.contains(value, keys::hash(value));
+                });
+
+                array result;
+                result.reserve(found.size());
+                for (auto f : found) {
+                    result.push_back(scalar(static_cast<bool>(f)));
+                }
+                ev.push(result);
+                break;
+            }
+            default:
+                invalid("expected a scalar or an array");
+        }
+    }
+}
+
+void falk::lib::unique(evaluator& ev, arguments& args) {
+    array values;
+    bool sorted;
+    if (!array_of(ev, args[0], "unique", values)
+        || !flag_of(ev, args, 1, "unique", sorted)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"unique", values.size(), [&] {
+        return trace::field("x", trace::shape(values));
+    }};
+    distinct(ev, values, sorted);
+}
+
+void falk::lib::unite(evaluator& ev, arguments& args) {
+    array a, b;
+    bool sorted;
+    if (!array_of(ev, args[0], "union", a)
+        || !array_of(ev, args[1], "union", b)
+        || !flag_of(ev, args, 2, "union", sorted)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"union", a.size() + b.size(), [&] {
+        return trace::field("a", trace::shape(a)) + ", "
+             + trace::field("b", trace::shape(b));
+    }};
+    a.extend(b);
+    distinct(ev, a, sorted);
+}
+
+void falk::lib::intersect(evaluator& ev, arguments& args) {
+    filter(ev, args, "intersect", true);
+}
+
+void falk::lib::setdiff(evaluator& ev, arguments& args) {
+    filter(ev, args, "setdiff", false);
+}
+
+void falk::lib::ismember(evaluator& ev, arguments& args) {
+    membership(ev, args, false);
+}
+
+void falk::lib::member(evaluator& ev, arguments& args) {
+    membership(ev, args, true);
+}
+
+void falk::lib::value_counts(evaluator& ev, arguments& args) {
+    array values;
+    bool sorted;
+    if (!array_of(ev, args[0], "value_counts", values)
+        || !flag_of(ev, args, 1, "value_counts", sorted)) {
+        ev.push(dict(true));
+        return;
+    }
+    trace::span traced{"value_counts", values.size(), [&] {
+        return trace::field("x", trace::shape(values));
+    }};
+
+    auto g = sorted ? group_sorted(values) : group(values, hashes(values));
+    dict result;
+    for (size_t i = 0; i < g.first.size(); i++) {
+        auto key = values.unchecked(g.first[i]);
+        result.insert(key, variable(scalar(g.count[i])));
+    }
+    ev.push(result);
+}
@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/parallel.hpp"
+#include "lib/sorting.hpp"
+#include "types/keys.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using namespace falk::lib;
+    namespace keys = falk::keys;
+    namespace trace = falk::trace;
+
+    constexpr uint64_t SIGN = uint64_t(1) << 63;
+
+    // Sorts each chunk of a large sequence in its own thread, then
+    // merges the chunks pairwise (also in parallel) until one is left.
+    template<typename T, typename Sort, typename Less>
+    void parallel_sort(std::vector<T>& items, Sort&& sort, Less&& less) {
+        auto n = items.size();
+        auto count = workers(n);
+        std::vector<size_t> bounds;
+        for (size_t t = 0; t <= count; t++) {
+            bounds.push_back(n * t / count);
+        }
+
+        parallel(count, [&](size_t t) {
+            sort(items.begin() + bounds[t], items.begin() + bounds[t + 1]);
+        });
+
+        std::vector<T> buffer(n);
+        while (bounds.size() > 2) {
+            auto chunks = bounds.size() - 1;
+            parallel((chunks + 1) / 2, [&](size_t p) {
+                auto first = items.begin() + bounds[2 * p];
+                auto middle = items.begin() + bounds[std::min(2 * p + 1, chunks)];
+                auto last = items.begin() + bounds[std::min(2 * p + 2, chunks)];
+                std::merge(first, middle, middle, last,
+                           buffer.begin() + bounds[2 * p], less);
+            });
+
+            std::vector<size_t> merged;
+            for (size_t i = 0; i < chunks; i += 2) {
+                merged.push_back(bounds[i]);
+            }
+            merged.push_back(n);
+            bounds = std::move(merged);
+            items.swap(buffer);
+        }
+    }
+
+    struct keyed {
+        uint64_t key;
+        uint32_t position;
+    };
+
+    // Maps a real number to an unsigned key with the same order: -0.0
+    // is the same as 0 and all NaNs come last.
+    uint64_t ordered(double value) {
+        if (std::isnan(value)) {
+            value = NAN;
+        } else if (value == 0) {
+            value = 0;
+        }
+
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & SIGN) ? ~bits : bits | SIGN;
+    }
+
+    // NaNs after every number, in both directions
+    bool above(double lhs, double rhs) {
+        return lhs > rhs || (!std::isnan(lhs) && std::isnan(rhs));
+    }
+
+    // Descending order of the elements of an array (which all have the
+    // same type): the reverse of keys::less, but with NaNs still last.
+    bool greater(const scalar& lhs, const scalar& rhs) {
+        if (lhs.inner_type() == falk::type::INT
+            && rhs.inner_type() == falk::type::INT) {
+            return lhs.integer() > rhs.integer();
+        }
+
+        auto l = lhs.real();
+        auto r = rhs.real();
+        if (l != r && !(std::isnan(l) && std::isnan(r))) {
+            return above(l, r);
+        }
+        return above(lhs.imag(), rhs.imag());
+    }
+
+    // Stable LSD radix sort by key, one byte per pass. Passes in which
+    // all keys have the same byte are skipped.
+    template<typename Iterator>
+    void radix_sort(Iterator first, Iterator last) {
+        std::vector<keyed> buffer(first, last);
+        std::vector<keyed> other(buffer.size());
+        for (size_t shift = 0; shift < 64; shift += 8) {
+            size_t counts[257] = {};
+            for (auto& item : buffer) {
+                ++counts[((item.key >> shift) & 0xFF) + 1];
+            }
+
+            if (std::count(counts + 1, counts + 257, 0) == 255) {
+                continue;
+            }
+
+            std::partial_sum(counts, counts + 257, counts);
+            for (auto& item : buffer) {
+                other[counts[(item.key >> shift) & 0xFF]++] = item;
+            }
+            buffer.swap(other);
+        }
+        std::copy(buffer.begin(), buffer.end(), first);
+    }
+
+    // Positions of the elements of an array, in sorted order (NaNs last
+    // in both directions). Arrays of real numbers (or integers, or
+    // booleans) are radix sorted by their bit patterns; complex numbers
+    // are compared.
+    std::vector<uint32_t> order(const array& values, bool descending) {
+        std::vector<uint32_t> result(values.size());
+        if (values.inner_type() == falk::type::COMPLEX) {
+            std::iota(result.begin(), result.end(), 0);
+            auto less = [&](uint32_t l, uint32_t r) {
+                return descending
+                    ? greater(values.unchecked(l), values.unchecked(r))
+                    : keys::less(values.unchecked(l), values.unchecked(r));
+            };
+            parallel_sort(result, [&](auto first, auto last) {
+                std::stable_sort(first, last, less);
+            }, less);
+            return result;
+        }
+
+        bool integers = values.inner_type() == falk::type::INT;
+        std::vector<keyed> items(values.size());
+        parallel_for(values.size(), [&](size_t i) {
+            auto value = values.unchecked(i);
+            auto key = integers ? uint64_t(value.integer()) ^ SIGN
+                                : ordered(value.real());
+            // reversed keys would put NaNs first: they get the largest
+            if (descending) {
+                key = std::isnan(value.real()) ? UINT64_MAX : ~key;
+            }
+            items[i] = {key, uint32_t(i)};
+        });
+
+        parallel_sort(items, [](auto first, auto last) {
+            radix_sort(first, last);
+        }, [](const keyed& l, const keyed& r) {
+            return l.key < r.key;
+        });
+
+        for (size_t i = 0; i < items.size(); i++) {
+            result[i] = items[i].position;
+        }
+        return result;
+    }
+}
+
+void falk::lib::sort(evaluator& ev, arguments& args) {
+    array values;
+    bool descending;
+    if (!array_of(ev, args[0], "sort", values)
+        || !flag_of(ev, args, 1, "sort", descending)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"sort", values.size(), [&] {
+        return trace::field("x", trace::shape(values));
+    }};
+
+    array result;
+    result.reserve(values.size());
+    for (auto i : order(values, descending)) {
+        result.push_back(values.unchecked(i));
+    }
+    ev.push(result);
+}
+
+void falk::lib::argsort(evaluator& ev, arguments& args) {
+    array values;
+    bool descending;
+    if (!array_of(ev, args[0], "argsort", values)
+        || !flag_of(ev, args, 1, "argsort", descending)) {
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"argsort", values.size(), [&] {
+        return trace::field("x", trace::shape(values));
+    }};
+
+    array result;
+    result.reserve(values.size());
+    for (auto i : order(values, descending)) {
+        result.push_back(scalar(int64_t(i)));
+    }
+    ev.push(result);
+}
+
+void falk::lib::sortrows(evaluator& ev, arguments& args) {
+    auto rows = ev.evaluate(args[0]);
+    scalar column;
+    bool descending;
+    if (rows.error() || !scalar_of(ev, args[1], "sortrows", column)
+        || !flag_of(ev, args, 2, "sortrows", descending)) {
+        ev.push(matrix(true));
+        return;
+    }
+
+    if (rows.stored_type() != structural::type::MATRIX) {
+        err::semantic<Error::INVALID_ARGUMENT>("sortrows",
+            "expected a matrix");
+        ev.push(matrix(true));
+        return;
+    }
+
+    auto& m = rows.value<matrix>();
+    auto c = column.integer();
+    if (c < 0 || c >= static_cast<int64_t>(m.column_count())) {
+        err::semantic<Error::INDEX_OUT_OF_BOUNDS>(m.column_count(), c);
+        ev.push(matrix(true));
+        return;
+    }
+    trace::span traced{"sortrows", m.row_count() * m.column_count(), [&] {
+        return trace::field("x", trace::shape(m));
+    }};
+
+    matrix result;
+    result.reserve(m.row_count(), m.column_count());
+    for (auto i : order(m.column(c), descending)) {
+        result.push_back(m.row(i));
+    }
+    ev.push(result);
+}
+
+void falk::lib::topk(evaluator& ev, arguments& args) {
+    array values;
+    scalar count;
+    bool smallest;
+    if (!array_of(ev, args[0], "topk", values)
+        || !scalar_of(ev, args[1], "topk", count)
+        || !flag_of(ev, args, 2, "topk", smallest)) {
+        ev.push(array(true));
+        return;
+    }
+
+    if (count.integer() < 0) {
+        err::semantic<Error::INVALID_ARGUMENT>("topk",
+            "the number of elements must be non-negative");
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"topk", values.size(), [&] {
+        return trace::field("x", trace::shape(values)) + ", "
+             + trace::field("k", std::to_string(count.integer()));
+    }};
+
+    // ties are broken by position, so the selection is stable
+    auto k = std::min<size_t>(count.integer(), values.size());
+    auto before = [&](uint32_t l, uint32_t r) {
+        auto lhs = values.unchecked(l);
+        auto rhs = values.unchecked(r);
+        if (smallest ? keys::less(lhs, rhs) : greater(lhs, rhs)) {
+            return true;
+        } else if (smallest ? keys::less(rhs, lhs) : greater(rhs, lhs)) {
+            return false;
+        }
+        return l < r;
+    };
+
+    std::vector<uint32_t> positions(values.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::nth_element(positions.begin(), positions.begin() + k,
+                     positions.end(), before);
+    std::sort(positions.begin(), positions.begin() + k, before);
+
+    array result;
+    result.reserve(k);
+    for (size_t i = 0; i < k; i++) {
+        result.push_back(values.unchecked(positions[i]));
+    }
+    ev.push(result);
+}
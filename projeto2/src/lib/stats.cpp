@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <cmath>
+
+#include "base/evaluator.hpp"
+#include "base/tracer.hpp"
+#include "lib/arguments.hpp"
+#include "lib/parallel.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+    using falk::array;
+    using falk::evaluator;
+    using falk::matrix;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+    using namespace falk::lib;
+    namespace trace = falk::trace;
+
+    // hist keeps one count per bin in each thread
+    constexpr int64_t MAX_BINS = 1 << 24;
+
+    // Count, mean and sum of squared deviations of a sequence, updated
+    // one element at a time (Welford) or by merging two sequences (Chan
+    // et al.).
+    struct moments {
+        double count = 0;
+        double mean = 0;
+        double m2 = 0;
+
+        void add(double x) {
+            count += 1;
+            auto delta = x - mean;
+            mean += delta / count;
+            m2 += delta * (x - mean);
+        }
+
+        void merge(const moments& other) {
+            if (other.count == 0) {
+                return;
+            }
+
+            auto total = count + other.count;
+            auto delta = other.mean - mean;
+            mean += delta * other.count / total;
+            m2 += other.m2 + delta * delta * count * other.count / total;
+            count = total;
+        }
+
+        double variance() const {
+            if (count == 0) {
+                return NAN;
+            }
+            return count > 1 ? m2 / (count - 1) : 0;
+        }
+    };
+
+    // Values of an array (as a single column) or matrix, row by row.
+    struct table {
+        const std::vector<scalar>* data;
+        size_t rows;
+        size_t columns;
+        bool complex;
+
+        const scalar& at(size_t i, size_t j) const {
+            return (*data)[i * columns + j];
+        }
+    };
+
+    // Moments of each column, over chunks of rows in parallel. part
+    // selects the real (0) or imaginary (1) part of the elements.
+    std::vector<moments> moments_of(const table& t, int part = 0) {
+        auto count = workers(t.rows * t.columns);
+        std::vector<std::vector<moments>> partial(count,
+            std::vector<moments>(t.columns));
+        parallel(count, [&](size_t c) {
+            auto end = t.rows * (c + 1) / count;
+            for (auto i = t.rows * c / count; i < end; i++) {
+                for (size_t j = 0; j < t.columns; j++) {
+                    auto& value = t.at(i, j);
+                    partial[c][j].add(part ? value.imag() : value.real());
+                }
+            }
+        });
+
+        for (size_t c = 1; c < count; c++) {
+            for (size_t j = 0; j < t.columns; j++) {
+                partial[0][j].merge(partial[c][j]);
+            }
+        }
+        return partial[0];
+    }
+
+    // Evaluates the data argument of a statistic, keeping the values
+    // in storage so that table can refer to them.
+    bool table_of(evaluator& ev, const falk::builtins::node_ptr& node,
+                  const std::string& fn, bool complex, variable& holder,
+                  std::vector<scalar>& storage, table& result) {
+        holder = ev.evaluate(node);
+        if (holder.error()) {
+            return false;
+        }
+
+        switch (holder.stored_type()) {
+            case S::ARRAY: {
+                const auto& a = holder.value<array>();
+                storage.assign(a.begin(), a.end());
+                result = {&storage, a.size(), 1,
+                          a.inner_type() == falk::type::COMPLEX};
+                break;
+            }
+            case S::MATRIX: {
+                const auto& m = holder.value<matrix>();
+                storage.clear();
+                storage.reserve(m.row_count() * m.column_count());
+                for (size_t i = 0; i < m.row_count(); i++) {
+                    for (size_t j = 0; j < m.column_count(); j++) {
+                        storage.push_back(m.unchecked(i, j));
+                    }
+                }
+                result = {&storage, m.row_count(), m.column_count(), false};
+                for (auto& value : storage) {
+                    result.complex |= value.inner_type() == falk::type::COMPLEX;
+                }
+                break;
+            }
+            default:
+                err::semantic<Error::INVALID_ARGUMENT>(fn,
+                    "expected an array or matrix");
+                return false;
+        }
+
+        if (result.complex && !complex) {
+            err::semantic<Error::INVALID_ARGUMENT>(fn,
+                "not defined for complex numbers");
+            return false;
+        }
+        return true;
+    }
+
+    // Pushes one value per column: a scalar for arrays, an array for
+    // matrices.
+    template<typename F>
+    void per_column(evaluator& ev, const table& t, const variable& source,
+                    F&& value) {
+        if (source.stored_type() == S::ARRAY) {
+            ev.push(value(0));
+            return;
+        }
+
+        array result;
+        result.reserve(t.columns);
+        for (size_t j = 0; j < t.columns; j++) {
+            result.push_back(value(j));
+        }
+        ev.push(result);
+    }
+
+    // NaNs come last
+    bool less(double l, double r) {
+        return l < r || (std::isnan(r) && !std::isnan(l));
+    }
+
+    // Quantile q of some values, which are partially reordered.
+    double select(std::vector<double>& values, double q) {
+        if (values.empty()) {
+            return NAN;
+        }
+
+        auto position = q * (values.size() - 1);
+        auto index = static_cast<size_t>(position);
+        auto fraction = position - index;
+        std::nth_element(values.begin(), values.begin() + index,
+                         values.end(), less);
+        auto low = values[index];
+        if (fraction == 0) {
+            return low;
+        }
+
+        auto high = *std::min_element(values.begin() + index + 1,
+                                      values.end(), less);
+        return low + fraction * (high - low);
+    }
+
+    // Pushes the quantiles qs of each column.
+    void quantiles(evaluator& ev, const table& t, const variable& source,
+                   const array& qs, bool single) {
+        std::vector<std::vector<double>> results(t.columns);
+        std::vector<double> column(t.rows);
+        for (size_t j = 0; j < t.columns; j++) {
+            for (auto q : qs) {
+                for (size_t i = 0; i < t.rows; i++) {
+                    column[i] = t.at(i, j).real();
+                }
+                results[j].push_back(select(column, q.real()));
+            }
+        }
+
+        if (single) {
+            per_column(ev, t, source, [&](size_t j) {
+                return scalar(results[j][0]);
+            });
+        } else if (source.stored_type() == S::ARRAY) {
+            array result;
+            for (auto value : results[0]) {
+                result.push_back(scalar(value));
+            }
+            ev.push(result);
+        } else {
+            // one row per quantile
+            matrix result;
+            result.reserve(qs.size(), t.columns);
+            for (size_t k = 0; k < qs.size(); k++) {
+                array row;
+                for (size_t j = 0; j < t.columns; j++) {
+                    row.push_back(scalar(results[j][k]));
+                }
+                result.push_back(row);
+            }
+            ev.push(result);
+        }
+    }
+}
+
+void falk::lib::mean(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (!table_of(ev, args[0], "mean", true, holder, storage, t)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    trace::span traced{"mean", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder));
+    }};
+
+    auto real = moments_of(t);
+    if (!t.complex) {
+        per_column(ev, t, holder, [&](size_t j) {
+            return scalar(t.rows ? real[j].mean : NAN);
+        });
+        return;
+    }
+
+    auto imag = moments_of(t, 1);
+    per_column(ev, t, holder, [&](size_t j) {
+        return scalar(std::complex<double>(real[j].mean, imag[j].mean));
+    });
+}
+
+void falk::lib::variance(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (!table_of(ev, args[0], "variance", false, holder, storage, t)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    trace::span traced{"variance", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder));
+    }};
+
+    auto m = moments_of(t);
+    per_column(ev, t, holder, [&](size_t j) {
+        return scalar(m[j].variance());
+    });
+}
+
+void falk::lib::stdev(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (!table_of(ev, args[0], "std", false, holder, storage, t)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    trace::span traced{"std", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder));
+    }};
+
+    auto m = moments_of(t);
+    per_column(ev, t, holder, [&](size_t j) {
+        return scalar(std::sqrt(m[j].variance()));
+    });
+}
+
+void falk::lib::median(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (!table_of(ev, args[0], "median", false, holder, storage, t)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+    trace::span traced{"median", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder));
+    }};
+
+    array half;
+    half.push_back(scalar(0.5));
+    quantiles(ev, t, holder, half, true);
+}
+
+void falk::lib::quantile(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (!table_of(ev, args[0], "quantile", false, holder, storage, t)) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    auto q = ev.evaluate(args[1]);
+    if (q.error()) {
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    array qs;
+    bool single = q.stored_type() == S::SCALAR;
+    if (single) {
+        qs.push_back(q.value<scalar>());
+    } else if (q.stored_type() == S::ARRAY) {
+        qs = q.value<array>();
+    } else {
+        err::semantic<Error::INVALID_ARGUMENT>("quantile",
+            "expected a scalar or array of quantiles");
+        ev.push(scalar::invalid());
+        return;
+    }
+
+    for (auto& value : qs) {
+        if (!(value.real() >= 0 && value.real() <= 1) || value.imag() != 0) {
+            err::semantic<Error::INVALID_ARGUMENT>("quantile",
+                "quantiles must be between 0 and 1");
+            ev.push(scalar::invalid());
+            return;
+        }
+    }
+    trace::span traced{"quantile", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder)) + ", "
+             + trace::field("q", std::to_string(qs.size()));
+    }};
+    quantiles(ev, t, holder, qs, single);
+}
+
+void falk::lib::cov(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    if (args.size() == 1) {
+        if (!table_of(ev, args[0], "cov", false, holder, storage, t)) {
+            ev.push(scalar::invalid());
+            return;
+        }
+    } else {
+        array a, b;
+        if (!array_of(ev, args[0], "cov", a)
+            || !array_of(ev, args[1], "cov", b)) {
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        if (a.size() != b.size()) {
+            err::semantic<Error::INVALID_ARGUMENT>("cov",
+                "arrays of different sizes");
+            ev.push(scalar::invalid());
+            return;
+        }
+
+        for (size_t i = 0; i < a.size(); i++) {
+            storage.push_back(a.unchecked(i));
+            storage.push_back(b.unchecked(i));
+        }
+        t = {&storage, a.size(), 2,
+             a.inner_type() == falk::type::COMPLEX
+             || b.inner_type() == falk::type::COMPLEX};
+        if (t.complex) {
+            err::semantic<Error::INVALID_ARGUMENT>("cov",
+                "not defined for complex numbers");
+            ev.push(scalar::invalid());
+            return;
+        }
+    }
+
+    if (t.rows < 2) {
+        err::semantic<Error::INVALID_ARGUMENT>("cov",
+            "expected at least two observations");
+        ev.push(scalar::invalid());
+        return;
+    }
+    trace::span traced{"cov", t.rows * t.columns, [&] {
+        return trace::field("observations", std::to_string(t.rows)) + ", "
+             + trace::field("variables", std::to_string(t.columns));
+    }};
+
+    // (X - mean)' * (X - mean) / (n - 1), through the matrix product
+    auto m = moments_of(t);
+    matrix centered, transposed;
+    centered.reserve(t.rows, t.columns);
+    transposed.reserve(t.columns, t.rows);
+    for (size_t i = 0; i < t.rows; i++) {
+        array row;
+        row.reserve(t.columns);
+        for (size_t j = 0; j < t.columns; j++) {
+            row.push_back(scalar(t.at(i, j).real() - m[j].mean));
+        }
+        centered.push_back(row);
+    }
+    for (size_t j = 0; j < t.columns; j++) {
+        transposed.push_back(centered.column(j));
+    }
+
+    auto result = transposed * centered;
+    result *= scalar(1.0 / (t.rows - 1));
+    if (args.size() == 1) {
+        ev.push(result);
+    } else {
+        ev.push(result.unchecked(0, 1));
+    }
+}
+
+void falk::lib::hist(evaluator& ev, arguments& args) {
+    variable holder;
+    std::vector<scalar> storage;
+    table t;
+    scalar bins;
+    if (!table_of(ev, args[0], "hist", false, holder, storage, t)
+        || !scalar_of(ev, args[1], "hist", bins)) {
+        ev.push(array(true));
+        return;
+    }
+
+    if (bins.inner_type() != falk::type::INT || bins.integer() < 1
+        || bins.integer() > MAX_BINS) {
+        err::semantic<Error::INVALID_ARGUMENT>("hist",
+            "the number of bins must be an integer from 1 to "
+            + std::to_string(MAX_BINS));
+        ev.push(array(true));
+        return;
+    }
+    trace::span traced{"hist", t.rows * t.columns, [&] {
+        return trace::field("x", trace::shape(holder)) + ", "
+             + trace::field("bins", std::to_string(bins.integer()));
+    }};
+
+    // the range defaults to that of the (non-NaN) elements
+    double lo = INFINITY, hi = -INFINITY;
+    for (auto& value : storage) {
+        if (!std::isnan(value.real())) {
+            lo = std::min(lo, value.real());
+            hi = std::max(hi, value.real());
+        }
+    }
+
+    scalar bound;
+    if (args.size() > 2) {
+        if (!scalar_of(ev, args[2], "hist", bound)) {
+            ev.push(array(true));
+            return;
+        }
+        lo = bound.real();
+    }
+    if (args.size() > 3) {
+        if (!scalar_of(ev, args[3], "hist", bound)) {
+            ev.push(array(true));
+            return;
+        }
+        hi = bound.real();
+    }
+
+    size_t n = bins.integer();
+    if (storage.empty() && args.size() < 4) {
+        lo = hi = 0;
+    } else if (!(lo <= hi)) {
+        err::semantic<Error::INVALID_ARGUMENT>("hist", "empty range");
+        ev.push(array(true));
+        return;
+    }
+
+    // the last bin also holds hi; if lo == hi, the first bin holds all
+    auto scale = hi > lo ? n / (hi - lo) : 0;
+    auto count = workers(storage.size());
+    std::vector<std::vector<int64_t>> partial(count,
+        std::vector<int64_t>(n));
+    parallel(count, [&](size_t c) {
+        auto end = storage.size() * (c + 1) / count;
+        for (auto i = storage.size() * c / count; i < end; i++) {
+            auto x = storage[i].real();
+            if (x >= lo && x <= hi) {
+                auto bin = static_cast<size_t>((x - lo) * scale);
+                ++partial[c][std::min(bin, n - 1)];
+            }
+        }
+    });
+
+    array result;
+    result.reserve(n);
+    for (size_t b = 0; b < n; b++) {
+        int64_t total = 0;
+        for (auto& counts : partial) {
+            total += counts[b];
+        }
+        result.push_back(scalar(total));
+    }
+    ev.push(result);
+}
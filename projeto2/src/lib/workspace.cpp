@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <iomanip>
+
+#include "base/errors.hpp"
+#include "base/evaluator.hpp"
+#include "lib/workspace.hpp"
+
+namespace {
+    using falk::array;
+    using falk::dict;
+    using falk::matrix;
+    using falk::scalar;
+    using falk::variable;
+    using S = falk::structural::type;
+
+    size_t footprint(const variable& value) {
+        auto bytes = sizeof(variable);
+        switch (value.stored_type()) {
+            case S::SCALAR:
+                return bytes + sizeof(scalar);
+            case S::ARRAY: {
+                auto& a = value.value<array>();
+                return bytes + sizeof(array) + a.capacity() * a.element_size();
+            }
+            case S::MATRIX: {
+                auto& m = value.value<matrix>();
+                return bytes + sizeof(matrix)
+                     + m.capacity() * m.element_size();
+            }
+            case S::DICT:
+                bytes += sizeof(dict);
+                value.value<dict>().for_each(
+                    [&](const scalar&, const variable& entry) {
+                        bytes += sizeof(scalar) + footprint(entry);
+                    });
+                return bytes;
+        }
+        return bytes;
+    }
+
+    std::string shape(const falk::lib::whos_entry& e) {
+        switch (e.s_type) {
+            case S::SCALAR:
+                return "-";
+            case S::ARRAY:
+                return "[" + std::to_string(e.columns) + "]";
+            case S::MATRIX:
+                return "[" + std::to_string(e.rows) + ", "
+                     + std::to_string(e.columns) + "]";
+            case S::DICT:
+                return "{" + std::to_string(e.rows) + "}";
+        }
+        return "";
+    }
+}
+
+std::vector<falk::lib::whos_entry>
+falk::lib::variables(const symbol_mapper& mapper) {
+    std::vector<whos_entry> result;
+    mapper.for_each_variable([&](const std::string& id, size_t depth,
+                                 const variable& value) {
+        whos_entry e{id, depth, value.stored_type(), falk::type::REAL,
+                     1, 1, footprint(value)};
+        switch (e.s_type) {
+            case S::SCALAR:
+                e.f_type = value.value<scalar>().inner_type();
+                break;
+            case S::ARRAY:
+                e.f_type = value.value<array>().inner_type();
+                e.columns = value.value<array>().size();
+                break;
+            case S::MATRIX: {
+                auto& m = value.value<matrix>();
+                e.f_type = m.inner_type();
+                e.rows = m.row_count();
+                e.columns = m.column_count();
+                break;
+            }
+            case S::DICT:
+                e.rows = value.value<dict>().size();
+                e.columns = 2;
+                break;
+        }
+        result.push_back(e);
+    });
+
+    // scopes are hash tables: names are sorted for a stable listing
+    std::stable_sort(result.begin(), result.end(),
+                     [](const whos_entry& a, const whos_entry& b) {
+                         return a.depth < b.depth
+                             || (a.depth == b.depth && a.name < b.name);
+                     });
+    return result;
+}
+
+void falk::lib::report(std::ostream& out, const symbol_mapper& mapper) {
+    auto entries = variables(mapper);
+    size_t totals[4] = {};
+    out << std::left << std::setw(16) << "name" << std::setw(7) << "scope"
+        << std::setw(8) << "class" << std::setw(9) << "type"
+        << std::setw(14) << "shape" << std::right << std::setw(12)
+        << "bytes" << "\n";
+    for (auto& e : entries) {
+        auto type = e.s_type == S::DICT ? std::string("-")
+                                        : err::type_table.at(e.f_type);
+        out << std::left << std::setw(16) << e.name << std::setw(7)
+            << e.depth << std::setw(8) << err::struct_type_table.at(e.s_type)
+            << std::setw(9) << type << std::setw(14) << shape(e)
+            << std::right << std::setw(12) << e.bytes << "\n";
+        totals[size_t(e.s_type)] += e.bytes;
+    }
+
+    size_t total = totals[0] + totals[1] + totals[2] + totals[3];
+    out << "total: " << entries.size() << " variables, " << total
+        << " bytes (scalars " << totals[size_t(S::SCALAR)] << ", arrays "
+        << totals[size_t(S::ARRAY)] << ", matrices "
+        << totals[size_t(S::MATRIX)] << ", dicts "
+        << totals[size_t(S::DICT)] << ")" << std::endl;
+}
+
+void falk::lib::whos(evaluator& ev, arguments&) {
+    matrix result;
+    for (auto& e : variables(ev.symbols())) {
+        array row;
+        row.push_back(scalar(static_cast<int64_t>(e.s_type)));
+        row.push_back(scalar(e.s_type == S::DICT
+                             ? int64_t(-1) : static_cast<int64_t>(e.f_type)));
+        row.push_back(scalar(static_cast<int64_t>(e.rows)));
+        row.push_back(scalar(static_cast<int64_t>(e.columns)));
+        row.push_back(scalar(static_cast<int64_t>(e.bytes)));
+        result.push_back(row);
+    }
+    ev.push(result);
+}
@@ -2,33 +2,92 @@
 #include <chrono>
 #include <fstream>
 #include <thread>
+#include <unistd.h>
+#include <vector>
 #include "aut/cursed/overterm.hpp"
+#include "base/audit.hpp"
+#include "base/profiler.hpp"
+#include "base/statistics.hpp"
+#include "base/tracer.hpp"
 #include "base/types.hpp"
 #include "lpi/lpa_context.hpp"
 #include "scanner.hpp"
 
 int main(int argc, char** argv) {
     using terminal = cursed::overterm<true>;
+    // options (--name) can appear anywhere, the remaining arguments are
+    // positional: [ncurses [console [file]]]
+    std::vector<std::string> args;
+    for (int i = 0; i < argc; i++) {
+        if (argv[i] == std::string("--stats")) {
+            falk::stats::enabled = true;
+        } else if (argv[i] == std::string("--profile")) {
+            falk::profiler::enabled = true;
+        } else if (argv[i] == std::string("--audit")) {
+            falk::audit::start();
+        } else if (argv[i] == std::string("--trace") && i + 1 < argc) {
+            falk::trace::start(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = args.size();
+
+    // ncurses is only used when both sides are terminals; otherwise
+    // (pipes and files) the standard streams are used, buffered
+    bool interactive = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
     std::unique_ptr<terminal> term;
-    if (argc <= 1 || argv[1] != std::to_string(0)) {
+    if (interactive && (argc <= 1 || args[1] != std::to_string(0))) {
         term = std::make_unique<terminal>();
+    } else if (!interactive) {
+        std::ios::sync_with_stdio(false);
     }
 
     lpi::lpa_context<falk::scanner, falk::parser, falk::analyser> context;
 
+    // no prompts when the input is not typed
+    context.console_mode(isatty(STDIN_FILENO));
     if (argc >= 3) {
-        context.console_mode(argv[2] != std::to_string(0));
+        context.console_mode(args[2] != std::to_string(0));
     }
 
     std::ifstream stream;
     if (argc >= 4) {
-        stream.open(argv[3], std::ifstream::in);
+        stream.open(args[3], std::ifstream::in);
         context.console_mode(false);
         context.switch_input_stream(&stream);
     }
 
+    if (falk::profiler::enabled) {
+        falk::profiler::start();
+    }
+
     auto ret = context.run();
 
+    if (falk::profiler::enabled) {
+        falk::profiler::stop();
+    }
+
+    if (falk::trace::enabled && !falk::trace::finish()) {
+        std::cerr << "cannot write the trace" << std::endl;
+    }
+
+    if (falk::stats::enabled || falk::profiler::enabled
+        || falk::audit::enabled) {
+        // after the terminal is restored
+        term.reset();
+        std::cout.flush();
+    }
+    if (falk::stats::enabled) {
+        falk::stats::report(std::cerr);
+    }
+    if (falk::profiler::enabled) {
+        falk::profiler::report(std::cerr);
+    }
+    if (falk::audit::enabled) {
+        falk::audit::report(std::cerr);
+    }
+
     // std::this_thread::sleep_for(std::chrono::seconds(10));
 
     return ret;
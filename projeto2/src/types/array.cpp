@@ -1,11 +1,129 @@
+#include <new>
+#include "base/audit.hpp"
 #include "types/array.hpp"
+#include "types/integers.hpp"
 #include "types/matrix.hpp"
 
+void falk::array::set(size_t index, const scalar& value) {
+    if (compact && value.inner_type() == falk::type::INT) {
+        packed[index] = value.integer();
+        return;
+    }
+
+    spill();
+    values[index] = value;
+    settle(value.inner_type());
+}
+
+void falk::array::push_back(const scalar& value) {
+    auto type = value.inner_type();
+    if (!compact && values.empty() && type == falk::type::INT
+        && falk::priority.at(value_type) <= falk::priority.at(type)) {
+        // the first integer of an empty array: the storage becomes dense,
+        // keeping the capacity reserved
+        value_type = type;
+        packed.reserve(values.capacity());
+        decltype(values)().swap(values);
+        compact = true;
+    }
+
+    if (compact && (type == falk::type::INT || type == falk::type::BOOL)) {
+        packed.push_back(value.integer());
+        return;
+    }
+
+    spill();
+    values.push_back(prepare(value));
+}
+
+falk::scalar falk::array::pop_back() {
+    if (compact) {
+        auto value = packed.back();
+        packed.pop_back();
+        return scalar(value);
+    }
+
+    auto value = values.back();
+    values.pop_back();
+    return value;
+}
+
+void falk::array::extend(const array& other) {
+    reserve(size() + other.size());
+    for (auto value : other) {
+        push_back(value);
+    }
+}
+
+bool falk::array::reserve(size_t capacity) {
+    try {
+        if (compact) {
+            if (capacity > packed.max_size()) {
+                return false;
+            }
+            packed.reserve(capacity);
+        } else {
+            if (capacity > values.max_size()) {
+                return false;
+            }
+            values.reserve(capacity);
+        }
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    return true;
+}
+
+void falk::array::spill() {
+    if (compact) {
+        values.reserve(packed.capacity());
+        for (auto value : packed) {
+            values.push_back(scalar(value));
+        }
+        decltype(packed)().swap(packed);
+        compact = false;
+    }
+}
+
+void falk::array::settle() {
+    if (value_type == falk::type::INT && !compact) {
+        for (auto& value : values) {
+            settle(value.inner_type());
+        }
+    }
+}
+
+void falk::array::settle(falk::type type) {
+    if (value_type == falk::type::INT
+        && falk::priority.at(type) > falk::priority.at(value_type)) {
+        coerce_to(type);
+    }
+}
+
+bool falk::array::combine(op::arithmetic operation, const array& rhs) {
+    if (!compact || !rhs.compact) {
+        return false;
+    }
+
+    decltype(packed) result(size());
+    if (!integers::apply(operation, packed.data(), false, rhs.packed.data(),
+                         false, result.data(), size())) {
+        return false;
+    }
+    packed.swap(result);
+    return true;
+}
+
 void falk::array::coerce_to(falk::type new_type) {
+    if (new_type != falk::type::INT) {
+        spill();
+    }
+
     auto new_priority = falk::priority.at(new_type);
     auto curr_priority = falk::priority.at(value_type);
     value_type = new_type;
     if (new_priority > curr_priority) {
+        audit::record(audit::conversion::COERCION, size() * sizeof(scalar));
         for (size_t i = 0; i < size(); i++) {
             values[i] = scalar(value_type, values[i].real(), values[i].imag());
         }
@@ -37,10 +155,16 @@ falk::array& falk::array::assign(const array& rhs) {
         return *this;
     }
 
+    if (compact && rhs.compact) {
+        packed = rhs.packed;
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < size(); i++) {
-        values[i].real() = rhs[i].real();
-        values[i].imag() = rhs[i].imag();
+        values[i].assign(rhs[i]);
     }
+    settle();
     return *this;
 }
 
@@ -131,9 +255,15 @@ falk::array& falk::array::operator+=(const array& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::ADD, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i] += rhs[i];
     }
+    settle();
     return *this;
 }
 
@@ -144,9 +274,15 @@ falk::array& falk::array::operator-=(const array& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::SUB, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i] -= rhs[i];
     }
+    settle();
     return *this;
 }
 
@@ -157,9 +293,15 @@ falk::array& falk::array::operator*=(const array& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::MULT, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i] *= rhs[i];
     }
+    settle();
     return *this;
 }
 
@@ -170,9 +312,11 @@ falk::array& falk::array::operator/=(const array& rhs) {
         return *this;
     }
 
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i] /= rhs[i];
     }
+    settle();
     return *this;
 }
 
@@ -183,9 +327,15 @@ falk::array& falk::array::operator%=(const array& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::MOD, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < size(); i++) {
-        values[i] %= rhs[i];                
+        values[i] %= rhs[i];
     }
+    settle();
     return *this;
 }
 
@@ -202,9 +352,11 @@ falk::array& falk::array::operator|=(const array& rhs) {
 }
 
 falk::array& falk::array::pow(const scalar& rhs) {
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i].pow(rhs);
     }
+    settle();
     return *this;
 }
 
@@ -214,10 +366,11 @@ falk::array& falk::array::pow(const array& rhs) {
         return *this;
     }
 
+    spill();
     for (size_t i = 0; i < size(); i++) {
         values[i].pow(rhs[i]);
     }
-
+    settle();
     return *this;
 }
 
@@ -228,6 +381,7 @@ falk::array& falk::array::pow(const matrix& rhs) {
 }
 
 falk::matrix falk::array::to_matrix() const {
+    audit::record(audit::conversion::PROMOTION, size() * element_size());
     matrix result;
     result.push_back(*this);
     return result;
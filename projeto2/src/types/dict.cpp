@@ -0,0 +1,90 @@
+#include "types/dict.hpp"
+#include "types/keys.hpp"
+
+int64_t falk::dict::locate(const scalar& key, uint64_t h) const {
+    return index.locate(h, [&](uint32_t position) {
+        return keys::equal(entries[position].key, key);
+    });
+}
+
+void falk::dict::rehash() {
+    // drops removed entries, keeping the insertion order
+    size_t live = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].alive) {
+            if (i != live) {
+                entries[live] = std::move(entries[i]);
+            }
+            ++live;
+        }
+    }
+    entries.erase(entries.begin() + live, entries.end());
+
+    index.reset(count + 1);
+    for (size_t i = 0; i < entries.size(); i++) {
+        index.place(keys::hash(entries[i].key), i);
+    }
+}
+
+falk::variable* falk::dict::find(const scalar& key) {
+    auto slot = locate(key, keys::hash(key));
+    return slot < 0 ? nullptr : &entries[index.position(slot)].value;
+}
+
+const falk::variable* falk::dict::find(const scalar& key) const {
+    auto slot = locate(key, keys::hash(key));
+    return slot < 0 ? nullptr : &entries[index.position(slot)].value;
+}
+
+void falk::dict::insert(const scalar& key, variable value) {
+    auto h = keys::hash(key);
+    auto slot = locate(key, h);
+    if (slot >= 0) {
+        entries[index.position(slot)].value = std::move(value);
+        return;
+    }
+
+    if (!index.fits()) {
+        rehash();
+    }
+
+    entries.push_back({key, std::move(value), true});
+    index.place(h, entries.size() - 1);
+    ++count;
+}
+
+bool falk::dict::erase(const scalar& key) {
+    auto slot = locate(key, keys::hash(key));
+    if (slot < 0) {
+        return false;
+    }
+
+    auto& e = entries[index.position(slot)];
+    e.alive = false;
+    e.value = variable();
+    index.erase(slot);
+    --count;
+    return true;
+}
+
+falk::array falk::dict::keys() const {
+    array result;
+    result.reserve(count);
+    for_each([&](const scalar& key, const variable&) {
+        result.push_back(key);
+    });
+    return result;
+}
+
+std::ostream& falk::operator<<(std::ostream& out, const dict& d) {
+    out << "{";
+    bool first = true;
+    d.for_each([&](const scalar& key, const variable& value) {
+        if (!first) {
+            out << ", ";
+        }
+        out << key << ": " << value;
+        first = false;
+    });
+    return out << "}";
+}
@@ -0,0 +1,39 @@
+#include "types/hash_index.hpp"
+
+constexpr size_t falk::hash_index::GROUP;
+constexpr uint8_t falk::hash_index::EMPTY;
+constexpr uint8_t falk::hash_index::DELETED;
+
+void falk::hash_index::place(uint64_t hash, uint32_t index) {
+    auto mask = control.size() - 1;
+    auto position = hash & mask & ~(GROUP - 1);
+    for (size_t step = 1; ; step++) {
+        auto free = match_free(load(position));
+        if (free) {
+            auto slot = position + lowest(free);
+            if (control[slot] == EMPTY) {
+                ++used;
+            }
+            control[slot] = fingerprint(hash);
+            slots[slot] = index;
+            return;
+        }
+        position = (position + step * GROUP) & mask;
+    }
+}
+
+void falk::hash_index::erase(int64_t slot) {
+    control[slot] = DELETED;
+}
+
+void falk::hash_index::reset(size_t n) {
+    // n positions fill at most 7/16 of the slots, leaving room for as
+    // many insertions before the next reset
+    size_t capacity = GROUP;
+    while (n * 16 > capacity * 7) {
+        capacity *= 2;
+    }
+    control.assign(capacity, EMPTY);
+    slots.assign(capacity, 0);
+    used = 0;
+}
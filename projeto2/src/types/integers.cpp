@@ -0,0 +1,113 @@
+#include <algorithm>
+#include "types/integers.hpp"
+
+namespace {
+    // Each operation stores its result and gives a word with the sign bit
+    // set on failure, so that loops gather failures without branching.
+    struct add {
+        uint64_t operator()(int64_t a, int64_t b, int64_t& result) const {
+            uint64_t sum = uint64_t(a) + uint64_t(b);
+            result = int64_t(sum);
+            // the sum has a sign different from both operands
+            return (uint64_t(a) ^ sum) & (uint64_t(b) ^ sum);
+        }
+    };
+
+    struct sub {
+        uint64_t operator()(int64_t a, int64_t b, int64_t& result) const {
+            uint64_t difference = uint64_t(a) - uint64_t(b);
+            result = int64_t(difference);
+            // the operands have different signs, and so do a and the
+            // difference
+            return (uint64_t(a) ^ uint64_t(b)) & (uint64_t(a) ^ difference);
+        }
+    };
+
+    struct mult {
+        uint64_t operator()(int64_t a, int64_t b, int64_t& result) const {
+            int64_t product;
+            bool overflow = __builtin_mul_overflow(a, b, &product);
+            result = product;
+            return uint64_t(overflow) << 63;
+        }
+    };
+
+    struct mod {
+        uint64_t operator()(int64_t a, int64_t b, int64_t& result) const {
+            // a modulus by zero is not a number, and any value modulo -1
+            // is 0 (INT64_MIN % -1 would overflow)
+            result = a % ((b == 0 || b == -1) ? 1 : b);
+            return uint64_t(b == 0) << 63;
+        }
+    };
+
+    template<typename F>
+    bool each(F f, const int64_t* lhs, bool single_lhs, const int64_t* rhs,
+              bool single_rhs, int64_t* result, size_t count) {
+        uint64_t failed = 0;
+        if (single_lhs) {
+            auto value = *lhs;
+            for (size_t i = 0; i < count; i++) {
+                failed |= f(value, rhs[i], result[i]);
+            }
+        } else if (single_rhs) {
+            auto value = *rhs;
+            for (size_t i = 0; i < count; i++) {
+                failed |= f(lhs[i], value, result[i]);
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                failed |= f(lhs[i], rhs[i], result[i]);
+            }
+        }
+        return (failed >> 63) == 0;
+    }
+}
+
+bool falk::integers::apply(op::arithmetic operation, const int64_t* lhs,
+                           bool single_lhs, const int64_t* rhs,
+                           bool single_rhs, int64_t* result, size_t count) {
+    switch (operation) {
+        case op::arithmetic::ADD:
+            return each(add(), lhs, single_lhs, rhs, single_rhs, result,
+                        count);
+        case op::arithmetic::SUB:
+            return each(sub(), lhs, single_lhs, rhs, single_rhs, result,
+                        count);
+        case op::arithmetic::MULT:
+            return each(mult(), lhs, single_lhs, rhs, single_rhs, result,
+                        count);
+        case op::arithmetic::MOD:
+            return each(mod(), lhs, single_lhs, rhs, single_rhs, result,
+                        count);
+        case op::arithmetic::DIV:
+        case op::arithmetic::POW:
+            break;
+    }
+    return false;
+}
+
+bool falk::integers::sum(const int64_t* values, size_t count,
+                         int64_t& result) {
+    // The high and low halves of the values are added apart, in blocks
+    // small enough for neither sum to overflow, so that the loop needs no
+    // checks.
+    constexpr size_t BLOCK = size_t(1) << 30;
+    __int128 total = 0;
+    for (size_t start = 0; start < count; start += BLOCK) {
+        auto end = std::min(count, start + BLOCK);
+        int64_t high = 0;
+        uint64_t low = 0;
+        for (size_t i = start; i < end; i++) {
+            high += values[i] >> 32;
+            low += uint64_t(values[i]) & 0xFFFFFFFF;
+        }
+        total += __int128(high) * 0x100000000 + low;
+    }
+
+    if (total < INT64_MIN || total > INT64_MAX) {
+        return false;
+    }
+    result = int64_t(total);
+    return true;
+}
@@ -0,0 +1,115 @@
+#include <cmath>
+#include <cstring>
+#include "types/keys.hpp"
+
+namespace {
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t bits(double value) {
+        if (std::isnan(value)) {
+            value = NAN;
+        }
+        uint64_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    // Keys with an integer value are compared (and hashed) as integers,
+    // whatever their type.
+    bool integral(const falk::scalar& key, int64_t& value) {
+        if (key.imag() != 0) {
+            return false;
+        }
+
+        if (key.inner_type() == falk::type::INT) {
+            value = key.integer();
+            return true;
+        }
+
+        auto real = key.real();
+        if (real == std::trunc(real) && real >= -9223372036854775808.0
+            && real < 9223372036854775808.0) {
+            value = static_cast<int64_t>(real);
+            return true;
+        }
+        return false;
+    }
+
+    bool same(double lhs, double rhs) {
+        return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+    }
+
+    // NaNs after every number
+    bool before(double lhs, double rhs) {
+        return lhs < rhs || (!std::isnan(lhs) && std::isnan(rhs));
+    }
+
+    // Sign of integer - real, computed without converting the integer
+    // (which would round it above 2^53).
+    int against(int64_t integer, double real) {
+        if (std::isnan(real) || real >= 9223372036854775808.0) {
+            return -1;
+        } else if (real < -9223372036854775808.0) {
+            return 1;
+        }
+
+        auto floor = std::floor(real);
+        auto bound = static_cast<int64_t>(floor);
+        if (integer != bound) {
+            return integer < bound ? -1 : 1;
+        }
+        return floor == real ? 0 : -1;
+    }
+
+    // -1, 0 or 1 as the real part of lhs comes before, is the same as or
+    // comes after that of rhs
+    int compare(const falk::scalar& lhs, const falk::scalar& rhs) {
+        bool li = lhs.inner_type() == falk::type::INT;
+        bool ri = rhs.inner_type() == falk::type::INT;
+        if (li && ri) {
+            return (lhs.integer() > rhs.integer())
+                 - (lhs.integer() < rhs.integer());
+        } else if (li) {
+            return against(lhs.integer(), rhs.real());
+        } else if (ri) {
+            return -against(rhs.integer(), lhs.real());
+        }
+
+        if (same(lhs.real(), rhs.real())) {
+            return 0;
+        }
+        return before(lhs.real(), rhs.real()) ? -1 : 1;
+    }
+}
+
+uint64_t falk::keys::hash(const scalar& key) {
+    int64_t value;
+    if (integral(key, value)) {
+        return mix(value);
+    }
+    return mix(bits(key.real()) ^ mix(bits(key.imag())));
+}
+
+bool falk::keys::equal(const scalar& lhs, const scalar& rhs) {
+    int64_t l, r;
+    bool li = integral(lhs, l);
+    bool ri = integral(rhs, r);
+    if (li || ri) {
+        return li && ri && l == r;
+    }
+    return same(lhs.real(), rhs.real()) && same(lhs.imag(), rhs.imag());
+}
+
+bool falk::keys::less(const scalar& lhs, const scalar& rhs) {
+    auto order = compare(lhs, rhs);
+    if (order != 0) {
+        return order < 0;
+    }
+    return before(lhs.imag(), rhs.imag());
+}
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <new>
+#include "base/audit.hpp"
+#include "base/tracer.hpp"
+#include "types/integers.hpp"
 #include "types/matrix.hpp"
 
 falk::scalar falk::matrix::invalid;
@@ -11,7 +16,7 @@ falk::array falk::matrix::row(size_t index) const {
     }
 
     for (size_t i = 0; i < num_columns; i++) {
-        result.push_back(at(index, i));
+        result.push_back(unchecked(index, i));
     }
     return result;
 }
@@ -25,25 +30,61 @@ falk::array falk::matrix::column(size_t index) const {
     }
 
     for (size_t i = 0; i < num_rows; i++) {
-        result.push_back(at(i, index));
+        result.push_back(unchecked(i, index));
     }
     return result;
 }
 
 falk::matrix& falk::matrix::assign_row(size_t index, const array& data) {
     for (size_t i = 0; i < num_columns; i++) {
-        at(index, i) = data[i];
+        set(index, i, data[i]);
     }
     return *this;
 }
 
 falk::matrix& falk::matrix::assign_column(size_t index, const array& data) {
     for (size_t i = 0; i < num_columns; i++) {
-        at(i, index) = data[i];
+        set(i, index, data[i]);
     }
     return *this;
 }
 
+void falk::matrix::set(size_t row, size_t column, const scalar& value) {
+    auto index = row * num_columns + column;
+    if (compact && value.inner_type() == falk::type::INT) {
+        packed[index] = value.integer();
+        return;
+    }
+
+    spill();
+    values[index] = value;
+    settle(value.inner_type());
+}
+
+bool falk::matrix::broadcast(op::arithmetic operation, const scalar& value,
+                             bool reversed, matrix& result) const {
+    if (!compact || value.inner_type() != falk::type::INT) {
+        return false;
+    }
+
+    auto integer = value.integer();
+    decltype(packed) elements(packed.size());
+    auto lhs = reversed ? &integer : packed.data();
+    auto rhs = reversed ? packed.data() : &integer;
+    if (!integers::apply(operation, lhs, reversed, rhs, !reversed,
+                         elements.data(), elements.size())) {
+        return false;
+    }
+
+    result = matrix();
+    result.packed.swap(elements);
+    result.compact = true;
+    result.num_rows = num_rows;
+    result.num_columns = num_columns;
+    result.value_type = falk::type::INT;
+    return true;
+}
+
 falk::matrix falk::operator*(const matrix& lhs, const matrix& rhs) {
     if (lhs.column_count() != rhs.row_count()) {
         err::semantic<Error::MATRIX_MULT_MISMATCH>(lhs.column_count(), rhs.row_count());
@@ -52,19 +93,24 @@ falk::matrix falk::operator*(const matrix& lhs, const matrix& rhs) {
 
     auto num_rows = lhs.row_count();
     auto num_columns = rhs.column_count();
+    auto work = num_rows * num_columns * lhs.column_count();
+    trace::span traced{"gemm", work, [&] {
+        return trace::field("lhs", trace::shape(lhs)) + ", "
+             + trace::field("rhs", trace::shape(rhs));
+    }};
     auto result = matrix(num_rows, num_columns);
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             scalar sum;
             for (size_t k = 0; k < lhs.column_count(); k++) {
-                auto factor = lhs.at(i, k) * rhs.at(k, j);
+                auto factor = lhs.unchecked(i, k) * rhs.unchecked(k, j);
                 if (k == 0) {
                     sum = factor;
                 } else {
                     sum += factor;
                 }
             }
-            result.at(i, j) = sum;
+            result.unchecked(i, j) = sum;
         }
     }
     return result;
@@ -81,7 +127,7 @@ std::ostream& falk::operator<<(std::ostream& out, const falk::matrix& mat) {
             if (j != 0) {
                out << ", ";
             }
-            out << mat.at(i, j);
+            out << mat.unchecked(i, j);
         }
         out << "]";
     }
@@ -89,6 +135,7 @@ std::ostream& falk::operator<<(std::ostream& out, const falk::matrix& mat) {
 }
 
 falk::scalar& falk::matrix::at(size_t row, size_t column) {
+    spill();
     if (row >= num_rows) {
         err::semantic<Error::INDEX_OUT_OF_BOUNDS>(num_rows, row);
         fail = true;
@@ -103,7 +150,7 @@ falk::scalar& falk::matrix::at(size_t row, size_t column) {
     return values.at(row * num_columns + column);
 }
 
-const falk::scalar& falk::matrix::at(size_t row, size_t column) const {
+falk::scalar falk::matrix::at(size_t row, size_t column) const {
     if (row >= num_rows) {
         err::semantic<Error::INDEX_OUT_OF_BOUNDS>(num_rows, row);
         return invalid;
@@ -113,12 +160,13 @@ const falk::scalar& falk::matrix::at(size_t row, size_t column) const {
         err::semantic<Error::INDEX_OUT_OF_BOUNDS>(num_columns, column);
         return invalid;
     }
-    return values.at(row * num_columns + column);
+    return unchecked(row, column);
 }
 
 void falk::matrix::push_back(const array& new_row) {
     auto row = prepare(new_row);
-    if (values.size() == 0) {
+    bool empty = values.empty() && packed.empty();
+    if (empty) {
         num_columns = row.size();
     }
 
@@ -128,36 +176,114 @@ void falk::matrix::push_back(const array& new_row) {
         return;
     }
 
+    if (empty && !compact && value_type == falk::type::INT) {
+        // the first row of integers: the storage becomes dense, keeping
+        // the capacity reserved
+        packed.reserve(values.capacity());
+        decltype(values)().swap(values);
+        compact = true;
+    }
+
     for (size_t i = 0; i < num_columns; i++) {
-        values.push_back(row[i]);
+        if (compact) {
+            packed.push_back(row.unchecked(i).integer());
+        } else {
+            values.push_back(row[i]);
+        }
     }
     ++num_rows;
 }
 
-void falk::matrix::push_front(const array& new_row) {
-    auto row = prepare(new_row);
-    if (values.size() == 0) {
-        num_columns = row.size();
+falk::array falk::matrix::pop_back() {
+    auto last = row(num_rows - 1);
+    if (compact) {
+        packed.resize(packed.size() - num_columns);
+    } else {
+        values.resize(values.size() - num_columns);
     }
+    --num_rows;
+    return last;
+}
 
-    if (row.size() != num_columns) {
-        err::semantic<Error::WRONG_COLUMN_COUNT>(num_columns, row.size());
-        fail = true;
-        return;
+bool falk::matrix::reserve(size_t rows, size_t columns) {
+    size_t count;
+    if (__builtin_mul_overflow(rows, columns, &count)) {
+        return false;
     }
 
-    for (size_t i = 0; i < num_columns; i++) {
-        values.push_front(row[num_columns - i - 1]);
+    try {
+        if (compact) {
+            if (count > packed.max_size()) {
+                return false;
+            }
+            packed.reserve(count);
+        } else {
+            if (count > values.max_size()) {
+                return false;
+            }
+            values.reserve(count);
+        }
+    } catch (const std::bad_alloc&) {
+        return false;
     }
-    ++num_rows;
+    return true;
+}
+
+void falk::matrix::spill() {
+    if (compact) {
+        values.reserve(packed.capacity());
+        for (auto value : packed) {
+            values.push_back(scalar(value));
+        }
+        decltype(packed)().swap(packed);
+        compact = false;
+    }
+}
+
+void falk::matrix::settle() {
+    if (value_type == falk::type::INT && !compact) {
+        for (auto& value : values) {
+            settle(value.inner_type());
+        }
+    }
+}
+
+void falk::matrix::settle(falk::type type) {
+    if (value_type == falk::type::INT
+        && falk::priority.at(type) > falk::priority.at(value_type)) {
+        value_type = type;
+        for (auto& value : values) {
+            value = scalar(type, value.real(), value.imag());
+        }
+    }
+}
+
+bool falk::matrix::combine(op::arithmetic operation, const matrix& rhs) {
+    if (!compact || !rhs.compact) {
+        return false;
+    }
+
+    decltype(packed) result(packed.size());
+    if (!integers::apply(operation, packed.data(), false, rhs.packed.data(),
+                         false, result.data(), result.size())) {
+        return false;
+    }
+    packed.swap(result);
+    return true;
 }
 
 falk::matrix& falk::matrix::assign(const scalar& rhs) {
+    if (compact && rhs.inner_type() == falk::type::INT) {
+        std::fill(packed.begin(), packed.end(), rhs.integer());
+        return *this;
+    }
+
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             at(i, j).assign(rhs);
         }
     }
+    settle();
     return *this;
 }
 
@@ -180,7 +306,7 @@ falk::matrix& falk::matrix::assign(const array& rhs) {
 
     for (size_t i = 0; i < row_count(); i++) {
         for (size_t j = 0; j < column_count(); j++) {
-            at(i, j) = value.at(i, j);
+            set(i, j, value.unchecked(i, j));
         }
     }
     return *this;
@@ -203,7 +329,7 @@ falk::matrix& falk::matrix::assign(const matrix& rhs) {
 
     for (size_t i = 0; i < row_count(); i++) {
         for (size_t j = 0; j < column_count(); j++) {
-            at(i, j) = rhs.at(i, j);
+            set(i, j, rhs.unchecked(i, j));
         }
     }
     return *this;
@@ -288,11 +414,17 @@ falk::matrix& falk::matrix::operator+=(const matrix& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::ADD, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < row_count(); i++) {
         for (size_t j = 0; j < column_count(); j++) {
             at(i, j) += rhs.at(i, j);
         }
     }
+    settle();
     return *this;
 }
 
@@ -311,11 +443,17 @@ falk::matrix& falk::matrix::operator-=(const matrix& rhs) {
         return *this;
     }
 
+    if (combine(op::arithmetic::SUB, rhs)) {
+        return *this;
+    }
+
+    spill();
     for (size_t i = 0; i < row_count(); i++) {
         for (size_t j = 0; j < column_count(); j++) {
             at(i, j) -= rhs.at(i, j);
         }
     }
+    settle();
     return *this;
 }
 
@@ -367,6 +505,9 @@ falk::array falk::matrix::prepare(const array& row) {
         copy.coerce_to(value_type);
         return copy;
     } else if (arr_priority > curr_priority) {
+        audit::record(audit::conversion::RETYPING,
+                      num_rows * num_columns * element_size());
+        spill();
         value_type = arr_type;
         for (size_t i = 0; i < num_rows; i++) {
             for (size_t j = 0; j < num_columns; j++) {
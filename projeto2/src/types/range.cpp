@@ -0,0 +1,97 @@
+#include <cmath>
+#include "types/range.hpp"
+
+namespace {
+    int64_t wrap(uint64_t value) {
+        return static_cast<int64_t>(value);
+    }
+
+    // number of steps of size 'magnitude' needed to cover 'distance'
+    uint64_t steps(uint64_t distance, uint64_t magnitude) {
+        return (distance - 1) / magnitude + 1;
+    }
+}
+
+falk::range::range(const scalar& first, const scalar& stop,
+                   const scalar& increment) {
+    value_type = falk::resolve_types(
+        falk::resolve_types(first.inner_type(), stop.inner_type()),
+        increment.inner_type());
+
+    if (value_type == falk::type::COMPLEX) {
+        err::semantic<Error::ILLEGAL_OPERATION>("complex range");
+        fail = true;
+        return;
+    }
+
+    if (value_type == falk::type::BOOL) {
+        value_type = falk::type::INT;
+    }
+
+    if (value_type == falk::type::INT) {
+        auto s = first.integer();
+        auto e = stop.integer();
+        auto k = increment.integer();
+        start = scalar(s);
+        step = scalar(k);
+        if (k == 0) {
+            err::semantic<Error::ILLEGAL_OPERATION>("range with zero step");
+            fail = true;
+        } else if (k > 0 && e > s) {
+            count = steps(uint64_t(e) - uint64_t(s), uint64_t(k));
+        } else if (k < 0 && e < s) {
+            count = steps(uint64_t(s) - uint64_t(e), 0 - uint64_t(k));
+        }
+        return;
+    }
+
+    start = scalar(first.real());
+    step = scalar(increment.real());
+    auto n = std::ceil((stop.real() - first.real()) / increment.real());
+    if (increment.real() == 0) {
+        err::semantic<Error::ILLEGAL_OPERATION>("range with zero step");
+        fail = true;
+    } else if (!std::isfinite(n)) {
+        err::semantic<Error::ILLEGAL_OPERATION>("unbounded range");
+        fail = true;
+    } else if (n > 0) {
+        count = n;
+    }
+}
+
+falk::scalar falk::range::operator[](size_t index) const {
+    if (value_type == falk::type::INT) {
+        return scalar(wrap(uint64_t(start.integer())
+                         + uint64_t(index) * uint64_t(step.integer())));
+    }
+    return scalar(start.real() + index * step.real());
+}
+
+falk::scalar falk::range::sum() const {
+    if (value_type == falk::type::INT) {
+        if (count == 0) {
+            return scalar(int64_t(0));
+        }
+        // n * (first + last) / 2, halving the even factor; the elements
+        // fit in 64 bits, so the product fits in 128
+        __int128 n = count;
+        auto last = (*this)[count - 1].integer();
+        __int128 ends = __int128(start.integer()) + last;
+        __int128 total = (n % 2 == 0) ? (n / 2) * ends : n * (ends / 2);
+        if (total >= INT64_MIN && total <= INT64_MAX) {
+            return scalar(int64_t(total));
+        }
+        // too large for an integer, as when added one by one
+        return scalar(double(total));
+    }
+    double m = count;
+    return scalar(m * start.real() + step.real() * m * (m - 1) / 2);
+}
+
+falk::array falk::range::to_array() const {
+    array result;
+    for (size_t i = 0; i < count; i++) {
+        result.push_back((*this)[i]);
+    }
+    return result;
+}
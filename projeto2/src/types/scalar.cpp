@@ -1,11 +1,35 @@
 
 #include <ostream>
+#include "base/audit.hpp"
 #include "types/scalar.hpp"
 #include "types/array.hpp"
 #include "types/matrix.hpp"
 
+namespace {
+    // Integer arithmetic is exact: a result which does not fit in 64 bits
+    // is computed as a real instead, as it was before integers existed.
+    bool power(int64_t base, int64_t exponent, int64_t& result) {
+        result = 1;
+        bool overflow = false;
+        while (exponent > 0) {
+            if (exponent & 1) {
+                overflow |= __builtin_mul_overflow(result, base, &result);
+            }
+            exponent >>= 1;
+            if (exponent > 0) {
+                overflow |= __builtin_mul_overflow(base, base, &base);
+            }
+        }
+        return !overflow;
+    }
+}
+
 falk::scalar& falk::scalar::pow(const scalar& rhs) {
     auto result_type = falk::resolve_types(_type, rhs._type);
+    if (result_type == falk::type::INT && rhs.integer() < 0) {
+        result_type = falk::type::REAL;
+    }
+    widen(result_type);
     switch (result_type) {
         case falk::type::COMPLEX: {
             auto result = std::pow(complex(), rhs.complex());
@@ -13,12 +37,20 @@ falk::scalar& falk::scalar::pow(const scalar& rhs) {
             _imag = result.imag();
             break;
         }
+        case falk::type::INT: {
+            int64_t result;
+            if (power(integer(), rhs.integer(), result)) {
+                return store(result);
+            }
+            return overflow(std::pow(real(), rhs.real()));
+        }
         case falk::type::REAL:
         case falk::type::BOOL:
             _real = std::pow(_real, rhs.real());
             break;
     }
 
+    normalize();
     return *this;
 }
 
@@ -35,8 +67,12 @@ falk::scalar& falk::scalar::pow(const matrix& rhs) {
 }
 
 falk::scalar& falk::scalar::assign(const scalar& rhs) {
+    widen(rhs._type);
+    if (_type == falk::type::INT) {
+        return store(rhs.integer());
+    }
     _real = rhs._real;
-    _imag = rhs._imag;
+    _imag = rhs.imag();
     return *this;
 }
 
@@ -54,74 +90,117 @@ falk::scalar& falk::scalar::assign(const matrix& rhs) {
 
 falk::scalar& falk::scalar::operator+=(const scalar& rhs) {
     auto type = falk::resolve_types(_type, rhs.inner_type());
+    widen(type);
     switch (type) {
         case falk::type::COMPLEX:
             _real += rhs._real;
-            _imag += rhs._imag;
+            _imag += rhs.imag();
             break;
+        case falk::type::INT: {
+            int64_t result;
+            if (!__builtin_add_overflow(integer(), rhs.integer(), &result)) {
+                return store(result);
+            }
+            return overflow(real() + rhs.real());
+        }
         case falk::type::REAL:
         case falk::type::BOOL:
             _real += rhs._real;
             break;
     }
+    normalize();
     return *this;
 }
 
 falk::scalar& falk::scalar::operator-=(const scalar& rhs) {
     auto type = falk::resolve_types(_type, rhs.inner_type());
+    widen(type);
     switch (type) {
         case falk::type::COMPLEX:
             _real -= rhs._real;
-            _imag -= rhs._imag;
+            _imag -= rhs.imag();
             break;
+        case falk::type::INT: {
+            int64_t result;
+            if (!__builtin_sub_overflow(integer(), rhs.integer(), &result)) {
+                return store(result);
+            }
+            return overflow(real() - rhs.real());
+        }
         case falk::type::REAL:
         case falk::type::BOOL:
             _real -= rhs._real;
             break;
     }
+    normalize();
     return *this;
 }
 
 falk::scalar& falk::scalar::operator*=(const scalar& rhs) {
     auto type = falk::resolve_types(_type, rhs.inner_type());
+    widen(type);
     switch (type) {
         case falk::type::COMPLEX:
             *this = complex() * rhs.complex();
             break;
+        case falk::type::INT: {
+            int64_t result;
+            if (!__builtin_mul_overflow(integer(), rhs.integer(), &result)) {
+                return store(result);
+            }
+            return overflow(real() * rhs.real());
+        }
         case falk::type::REAL:
         case falk::type::BOOL:
             _real *= rhs.real();
             break;
     }
+    normalize();
     return *this;
 }
 
 falk::scalar& falk::scalar::operator/=(const scalar& rhs) {
     auto type = falk::resolve_types(_type, rhs.inner_type());
+    // division of integers is not closed, the result is a real
+    if (type == falk::type::INT) {
+        type = falk::type::REAL;
+    }
+    widen(type);
     switch (type) {
         case falk::type::COMPLEX:
             *this = complex() / rhs.complex();
             break;
+        case falk::type::INT:
         case falk::type::REAL:
         case falk::type::BOOL:
             _real /= rhs.real();
             break;
     }
+    normalize();
     return *this;
 }
 
 falk::scalar& falk::scalar::operator%=(const scalar& rhs) {
     auto type = falk::resolve_types(_type, rhs.inner_type());
+    widen(type);
     switch (type) {
         case falk::type::COMPLEX:
             err::semantic<Error::ILLEGAL_OPERATION>("complex modulus");
             fail = true;
             break;
+        case falk::type::INT:
+            if (rhs.integer() == 0) {
+                // not a number, as for reals
+                return overflow(std::fmod(real(), rhs.real()));
+            }
+            // INT64_MIN % -1 overflows
+            return store(rhs.integer() == -1 ? 0 : integer() % rhs.integer());
         case falk::type::REAL:
         case falk::type::BOOL:
             _real = std::fmod(real(), rhs.real());
             break;
     }
+    normalize();
     return *this;
 }
 
@@ -129,6 +208,7 @@ falk::scalar& falk::scalar::operator&=(const scalar& rhs) {
     switch (_type) {
         case falk::type::COMPLEX:
         case falk::type::REAL:
+        case falk::type::INT:
             err::semantic<Error::ILLEGAL_ASSIGNMENT>(_type,
                                                      falk::type::BOOL);
             fail = true;
@@ -145,6 +225,7 @@ falk::scalar& falk::scalar::operator|=(const scalar& rhs) {
     switch (type) {
         case falk::type::COMPLEX:
         case falk::type::REAL:
+        case falk::type::INT:
             err::semantic<Error::ILLEGAL_ASSIGNMENT>(type,
                                                      falk::type::BOOL);
             fail = true;
@@ -242,6 +323,7 @@ falk::scalar& falk::scalar::operator|=(const matrix& rhs) {
 
 falk::scalar falk::scalar::pow(const scalar& lhs, const scalar& rhs) {
     auto copy = lhs;
+    copy.inner_type(falk::resolve_types(lhs.inner_type(), rhs.inner_type()));
     return copy.pow(rhs);
 }
 
@@ -294,6 +376,11 @@ falk::scalar falk::operator%(const scalar& lhs, const scalar& rhs) {
 falk::scalar falk::operator-(const scalar& n) {
     auto type = n.inner_type();
     switch (type) {
+        case falk::type::INT:
+            if (n.integer() == INT64_MIN) {
+                return scalar(-n.real());
+            }
+            return scalar(-n.integer());
         case falk::type::COMPLEX:
         case falk::type::REAL:
         case falk::type::BOOL:
@@ -302,10 +389,7 @@ falk::scalar falk::operator-(const scalar& n) {
 }
 
 falk::scalar falk::operator!(const scalar& n) {
-    auto copy = n;
-    copy.real() = (copy.real() == 0) ? 1 : 0;
-    copy.inner_type(falk::type::BOOL);
-    return copy;
+    return {falk::type::BOOL, (n.real() == 0) ? 1.0 : 0.0, n.imag()};
 }
 
 falk::array falk::scalar::to_array(size_t size) const {
@@ -313,6 +397,8 @@ falk::array falk::scalar::to_array(size_t size) const {
     for (size_t i = 0; i < size; i++) {
         result.push_back(*this);
     }
+    audit::record(audit::conversion::BROADCAST,
+                  size * result.element_size());
     return result;
 }
 
@@ -337,9 +423,14 @@ falk::array falk::operator%(const scalar& lhs, const array& rhs) {
 }
 
 falk::matrix falk::operator+(const scalar& lhs, const matrix& rhs) {
+    matrix result;
+    if (rhs.broadcast(op::arithmetic::ADD, lhs, true, result)) {
+        return result;
+    }
+
     auto num_rows = rhs.row_count();
     auto num_columns = rhs.column_count();
-    auto result = matrix(num_rows, num_columns);
+    result = matrix(num_rows, num_columns);
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             result.at(i, j) = lhs + rhs.at(i, j);
@@ -349,9 +440,14 @@ falk::matrix falk::operator+(const scalar& lhs, const matrix& rhs) {
 }
 
 falk::matrix falk::operator-(const scalar& lhs, const matrix& rhs) {
+    matrix result;
+    if (rhs.broadcast(op::arithmetic::SUB, lhs, true, result)) {
+        return result;
+    }
+
     auto num_rows = rhs.row_count();
     auto num_columns = rhs.column_count();
-    auto result = matrix(num_rows, num_columns);
+    result = matrix(num_rows, num_columns);
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             result.at(i, j) = lhs - rhs.at(i, j);
@@ -361,9 +457,14 @@ falk::matrix falk::operator-(const scalar& lhs, const matrix& rhs) {
 }
 
 falk::matrix falk::operator*(const scalar& lhs, const matrix& rhs) {
+    matrix result;
+    if (rhs.broadcast(op::arithmetic::MULT, lhs, true, result)) {
+        return result;
+    }
+
     auto num_rows = rhs.row_count();
     auto num_columns = rhs.column_count();
-    auto result = matrix(num_rows, num_columns);
+    result = matrix(num_rows, num_columns);
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             result.at(i, j) = lhs * rhs.at(i, j);
@@ -385,9 +486,14 @@ falk::matrix falk::operator/(const scalar& lhs, const matrix& rhs) {
 }
 
 falk::matrix falk::operator%(const scalar& lhs, const matrix& rhs) {
+    matrix result;
+    if (rhs.broadcast(op::arithmetic::MOD, lhs, true, result)) {
+        return result;
+    }
+
     auto num_rows = rhs.row_count();
     auto num_columns = rhs.column_count();
-    auto result = matrix(num_rows, num_columns);
+    result = matrix(num_rows, num_columns);
     for (size_t i = 0; i < num_rows; i++) {
         for (size_t j = 0; j < num_columns; j++) {
             result.at(i, j) = lhs % rhs.at(i, j);
@@ -409,6 +515,9 @@ std::ostream& falk::operator<<(std::ostream& out, const scalar& n) {
         case falk::type::REAL:
             out << n.real();
             break;
+        case falk::type::INT:
+            out << n.integer();
+            break;
         case falk::type::BOOL:
             out << std::boolalpha << n.boolean() << std::noboolalpha;
             break;
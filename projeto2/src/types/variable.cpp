@@ -0,0 +1,50 @@
+#include "types/variable.hpp"
+
+falk::variable::variable(const variable& other):
+  type{other.type}, fail{other.fail} {
+    switch (type) {
+        case falk::structural::type::SCALAR:
+            data = variant(other.value<scalar>());
+            break;
+        case falk::structural::type::ARRAY:
+            data = variant(other.value<array>());
+            break;
+        case falk::structural::type::MATRIX:
+            data = variant(other.value<matrix>());
+            break;
+        case falk::structural::type::DICT:
+            data = variant(other.value<dict>());
+            break;
+    }
+}
+
+falk::variable& falk::variable::operator=(const variable& other) {
+    variable copy(other);
+    return *this = std::move(copy);
+}
+
+std::ostream& falk::operator<<(std::ostream& out, const variable& v) {
+    switch (v.stored_type()) {
+        case falk::structural::type::SCALAR: {
+            auto& raw = v.value<scalar>();
+            out << raw;
+            break;
+        }
+        case falk::structural::type::ARRAY: {
+            auto& raw = v.value<array>();
+            out << raw;
+            break;
+        }
+        case falk::structural::type::MATRIX: {
+            auto& raw = v.value<matrix>();
+            out << raw;
+            break;
+        }
+        case falk::structural::type::DICT: {
+            auto& raw = v.value<dict>();
+            out << raw;
+            break;
+        }
+    }
+    return out;
+}
@@ -1,6 +1,7 @@
 /* created by Ghabriel Nunes <ghabriel.nunes@gmail.com> [2016] */
 
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <fstream>
 #include <list>
 #include "aux/Connection.hpp"
@@ -67,6 +68,7 @@ namespace {
             }
 
             if (!run(in, actual, expected, padded)) {
+                ADD_FAILURE() << "unexpected output";
                 break;
             }
             ++out_it;
@@ -100,7 +102,26 @@ namespace {
             padded = true;
         }
 
-        run("[content of " + in_file + "]", actual, expected, padded);
+        if (!run("[content of " + in_file + "]", actual, expected, padded)) {
+            ADD_FAILURE() << "unexpected output";
+        }
+    }
+
+    // output of a program run with the given options, for reports whose
+    // timings vary between runs
+    template<typename... Options>
+    std::string run_with(const Container& inputs, Options... options) {
+        Connection program("./bin/falk", "0", "0", options...);
+        program.send(*inputs.begin() + "\n");
+        return program.receive();
+    }
+
+    void expect_report(const std::string& report,
+                       const std::list<std::string>& fragments) {
+        for (auto& fragment : fragments) {
+            EXPECT_NE(report.find(fragment), std::string::npos)
+                << "missing \"" << fragment << "\" in:" << std::endl << report;
+        }
     }
 }
 
@@ -486,9 +507,406 @@ TEST_F(FalkTest, interpreter_v10) {
     run_test("tests/cases/3.falk", "tests/cases/3.out");
 }
 
+TEST_F(FalkTest, interpreter_v11) {
+    Container inputs;
+    Container outputs;
+    inputs.add("array a = [1, 2, 3]", "array b = [4, 5, 6]",
+        "array c = [0, 0, 0]", "var i = 0",
+        "while (i < 3): c[i] = a[i] * b[i]; i += 1.", "c", "i");
+    outputs.add("res = [4, 10, 18]", "res = 3");
+
+    inputs.add("matrix m = [[1, 2], [3, 4]]", "matrix n = [[0, 0], [0, 0]]",
+        "var i = 0", "while (i < 2): n[i] = m[i] + 1; i += 1.", "n",
+        "array acc = [0, 0]", "for (r in m): acc += r.", "acc");
+    outputs.add("res = [[2, 3], [4, 5]]", "res = [4, 6]");
+
+    inputs.add("array a = [1, 2]", "array c = [0, 0, 0]", "var i = 0",
+        "while (i < 3): c[i] = a[i]; i += 1.");
+    outputs.add("[Line 3] semantic error: index out of bounds "
+        "(limit = 2, actual = 2)");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v12) {
+    Container inputs;
+    Container outputs;
+    inputs.add("matrix m = [[1, 2], [3, 4]]", "var s = 0", "var i = 0",
+        "while (i < 2):", "var j = 0",
+        "while (j < 2): s += m[i, j]; m[i, j] = s; j += 1.",
+        "i += 1", ".", "s", "m");
+    outputs.add("res = 10", "res = [[1, 3], [6, 10]]");
+
+    inputs.add("array a = [1, 2, 3]", "var s = 0", "var i = 0",
+        "while (i <= 3): s += a[i]; i += 1.");
+    outputs.add("[Line 3] semantic error: index out of bounds "
+        "(limit = 3, actual = 3)");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v13) {
+    Container inputs;
+    Container outputs;
+    inputs.add("var n = 9007199254740993", "n + 0", "n * 2", "n / 2");
+    outputs.add("res = 9007199254740993", "res = 18014398509481986",
+        "res = 4.5036e+15");
+
+    inputs.add("var x : int", "x += 7", "x % 4", "x / 2", "x = 1.5", "x",
+        "x += 0.75", "x");
+    outputs.add("res = 3", "res = 3.5", "res = 1", "res = 1");
+
+    inputs.add("var z = 1", "z = 2.5", "z", "var x : int", "var k = x",
+        "k = 0.5", "k");
+    outputs.add("res = 2.5", "res = 0.5");
+
+    inputs.add("2 ** 62", "2 ** -1", "7 % 0", "2 ** 64",
+        "9223372036854775807 + 1", "-(-9223372036854775807 - 1)",
+        "3037000500 * 3037000500");
+    outputs.add("res = 4611686018427387904", "res = 0.5", "res = -nan",
+        "res = 1.84467e+19", "res = 9.22337e+18", "res = 9.22337e+18",
+        "res = 9.22337e+18");
+
+    inputs.add("var x : int", "x = 9223372036854775807", "x += 1", "x",
+        "var s = 0", "for (i in 0..5000000000): s += i.", "s");
+    outputs.add("res = 9223372036854775807", "res = 1.25e+19");
+
+    inputs.add("array a = [1, 2, 3]", "a + [4, 5, 6]", "a * 2",
+        "[9223372036854775807, 1] + [1, 1]", "a[0] = 0.5", "a", "a[5] = 1",
+        "matrix m = [[1, 2], [3, 4]]", "1 - m",
+        "m[1, 1] += 9223372036854775807", "m");
+    outputs.add("res = [5, 7, 9]", "res = [2, 4, 6]",
+        "res = [9.22337e+18, 2]", "res = [0.5, 2, 3]",
+        "[Line 6] semantic error: index out of bounds (limit = 3, actual = 5)",
+        "res = [[0, -1], [-2, -3]]", "res = [[1, 2], [3, 9.22337e+18]]");
+
+    inputs.add("array b = [9223372036854775807, 1]", "var s = 0",
+        "for (x in b): s += x.", "s", "array c = [1, 2, 3]", "var t = 10",
+        "for (x in c): t -= x.", "t");
+    outputs.add("res = 9.22337e+18", "res = 4");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v14) {
+    Container inputs;
+    Container outputs;
+    inputs.add("var s = 0", "for (i in 0..1000000000): s += i.", "s",
+        "for (x in 6..0:-3): x.");
+    outputs.add("res = 499999999500000000", "res = 6", "res = 3");
+
+    inputs.add("array r = 0..2:0.5", "r", "0..3:0");
+    outputs.add("res = [0, 0.5, 1, 1.5]",
+        "[Line 2] semantic error: illegal operation: range with zero step");
+
+    inputs.add("var x = 0", "var i = 0",
+        "while (i < 3): i += 1; if (i == 2): x += 1..", "x",
+        "for (k in 0..2): if (k > 0): x += k..", "x");
+    outputs.add("res = 1", "res = 2");
+
+    inputs.add("var n = 3", "array r = 0.. n", "r", "for (k in 1 ..\t2): k.");
+    outputs.add("res = [0, 1, 2]", "res = 1");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v15) {
+    Container inputs;
+    Container outputs;
+    inputs.add("array a = [1]", "reserve(a, 10)",
+        "for (i in 2..5): append(a, i).", "pop(a)", "extend(a, [7, 8])", "a");
+    outputs.add("res = 4", "res = [1, 2, 3, 7, 8]");
+
+    inputs.add("matrix m = [[1, 2]]", "append(m, [3])", "append(m, [3, 4])",
+        "pop(m)", "array e = [1]", "pop(e)", "pop(e)");
+    outputs.add("[Line 1] semantic error: mismatching column count "
+        "(expected 2, got 1)", "res = [3, 4]", "res = 1",
+        "[Line 6] semantic error: illegal operation: pop from an empty "
+        "structure");
+
+    inputs.add("array a = [1.5]", "reserve(a, 4611686018427387904)",
+        "matrix m = [[1, 2]]", "reserve(m, 9223372036854775807)",
+        "reserve(m, 4)", "append(m, [3, 4])", "m");
+    outputs.add("[Line 1] semantic error: invalid argument for function "
+        "reserve: the capacity is too large",
+        "[Line 3] semantic error: invalid argument for function "
+        "reserve: the capacity is too large", "res = [[1, 2], [3, 4]]");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v16) {
+    Container inputs;
+    Container outputs;
+    inputs.add("dict d", "d[1] = 10", "d[2.5] = [1, 2]", "d[true] += 5",
+        "d", "has(d, 1.0)", "get(d, 7, -1)", "remove(d, 2.5)", "keys(d)");
+    outputs.add("res = {1: 15, 2.5: [1, 2]}", "res = true", "res = -1",
+        "res = [1]");
+
+    inputs.add("dict e = todict([3, 1, 2], [30, 10, 20])", "var s = 0",
+        "for (k in e): s += k * e[k].", "s", "e[4] += 1", "e + 1");
+    outputs.add("res = 140", "[Line 4] semantic error: key 4 not found",
+        "[Line 5] semantic error: illegal operation: dictionary arithmetic");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v17) {
+    Container inputs;
+    Container outputs;
+    inputs.add("array a = [3, 1, 3.0, 2, true, 5]", "unique(a)",
+        "unique(a, true)", "union([4, 1], [1, 7])", "intersect(a, [5, 3, 9])",
+        "setdiff(a, [5, 3, 9], true)");
+    outputs.add("res = [3, 1, 2, 5]", "res = [1, 2, 3, 5]", "res = [4, 1, 7]",
+        "res = [3, 5]", "res = [1, 2]");
+
+    inputs.add("array b = [2, 2, 7]", "ismember([1, 7], b)", "2 in b",
+        "value_counts(b)", "unique(2)");
+    outputs.add("res = [false, true]", "res = true", "res = {2: 2, 7: 1}",
+        "[Line 4] semantic error: invalid argument for function unique: "
+        "expected an array");
+
+    inputs.add("array n = [0/0, 1, 0/0]", "unique(n)", "value_counts(n)",
+        "1 in 2");
+    outputs.add("res = [-nan, 1]", "res = {-nan: 2, 1: 1}",
+        "[Line 3] semantic error: invalid operand for operator in: "
+        "expected an array");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v18) {
+    Container inputs;
+    Container outputs;
+    inputs.add("array a = [3.5, -1, 2, 0, 7, 2]", "sort(a)", "sort(a, true)",
+        "argsort(a)", "topk(a, 3)", "topk(a, 2, true)", "sort([1i, 2, -1])");
+    outputs.add("res = [-1, 0, 2, 2, 3.5, 7]", "res = [7, 3.5, 2, 2, 0, -1]",
+        "res = [1, 3, 2, 5, 0, 4]", "res = [7, 3.5, 2]", "res = [-1, 0]",
+        "res = [-1 + 0i, 0 + 1i, 2 + 0i]");
+
+    inputs.add("array a = [2, 0/0, -1, 5]", "sort(a)", "sort(a, true)",
+        "argsort(a, true)", "topk(a, 2)", "sort([1i, 0/0 + 1i, 2], true)");
+    outputs.add("res = [-1, 2, 5, -nan]", "res = [5, 2, -1, -nan]",
+        "res = [3, 0, 2, 1]", "res = [5, 2]",
+        "res = [2 + 0i, 0 + 1i, -nan + 1i]");
+
+    inputs.add("matrix m = [[3, 1], [1, 2], [2, 0], [1, 1]]",
+        "sortrows(m, 0)", "sortrows(m, 1, true)", "sortrows(m, 2)");
+    outputs.add("res = [[1, 2], [1, 1], [2, 0], [3, 1]]",
+        "res = [[1, 2], [3, 1], [1, 1], [2, 0]]",
+        "[Line 3] semantic error: index out of bounds (limit = 2, actual = 2)");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v19) {
+    Container inputs;
+    Container outputs;
+    inputs.add("exp(1)", "log([1, 2.718281828459045])", "cos([0, 3.141592653589793])",
+        "sqrt(-4 + 0i)", "abs([-3, 2.5, 3 + 4i])", "floor([2.7, -2.5, 3])",
+        "floor(1i)");
+    outputs.add("res = 2.71828", "res = [0, 1]", "res = [1, -1]", "res = 0 + 2i",
+        "res = [3, 2.5, 5]", "res = [2, -3, 3]",
+        "[Line 6] semantic error: invalid argument for function floor: "
+        "not defined for complex numbers");
+
+    inputs.add("matrix m = [[1, 4], [9, 16]]", "sqrt(m)", "strict_math(true)",
+        "sin(0.5)");
+    outputs.add("res = [[1, 2], [3, 4]]", "res = 0.479426");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v20) {
+    Container inputs;
+    Container outputs;
+    inputs.add("seed(42)", "rand()", "rand(3)", "seed(42)", "rand(4)",
+        "randint(1, 6, 8)");
+    outputs.add("res = 0.596119", "res = [0.160365, 0.166398, 0.0480258]",
+        "res = [0.596119, 0.160365, 0.166398, 0.0480258]",
+        "res = [6, 2, 2, 1, 5, 2, 5, 6]");
+
+    inputs.add("seed(1)", "auto m = randn(2, 3)", "abs(m[1, 2]) < 10",
+        "randint(3, 1)");
+    outputs.add("res = true", "[Line 3] semantic error: invalid argument "
+        "for function randint: empty interval");
+
+    inputs.add("rand(4294967296)", "randn(3037000500, 3037000500)",
+        "randint(0, 9, 65536, 65537)");
+    outputs.add("[Line 0] semantic error: invalid argument for function "
+        "rand: too many elements", "[Line 1] semantic error: invalid "
+        "argument for function randn: too many elements",
+        "[Line 2] semantic error: invalid argument for function "
+        "randint: too many elements");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v21) {
+    Container inputs;
+    Container outputs;
+    inputs.add("auto a = [2, 4, 4, 5, 9]", "mean(a)", "variance(a)",
+        "median(a)", "quantile(a, [0, 0.25, 1])", "hist(a, 4)");
+    outputs.add("res = 4.8", "res = 6.7", "res = 4", "res = [2, 4, 9]",
+        "res = [1, 3, 0, 1]");
+
+    inputs.add("matrix m = [[1, 2], [3, 6], [5, 7]]", "mean(m)", "cov(m)",
+        "cov([1, 2, 3], [2, 4, 7])", "variance([1i])");
+    outputs.add("res = [3, 5]", "res = [[4, 5], [5, 7]]", "res = 2.5",
+        "[Line 4] semantic error: invalid argument for function variance: "
+        "not defined for complex numbers");
+
+    inputs.add("hist([1, 2], 16777217)", "hist([1, 2], 2)");
+    outputs.add("[Line 0] semantic error: invalid argument for function "
+        "hist: the number of bins must be an integer from 1 to 16777216",
+        "res = [1, 1]");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v22) {
+    Container inputs;
+    Container outputs;
+    inputs.add("fft([1, 2, 3, 4])", "ifft(fft([1, 2, 3, 4]))",
+        "rfft([1, 2, 3, 4])", "fft([1, 0, 0])");
+    outputs.add("res = [10 + 0i, -2 + 2i, -2 + 0i, -2 - 2i]",
+        "res = [1 + 0i, 2 + 0i, 3 + 0i, 4 + 0i]",
+        "res = [10 + 0i, -2 + 2i, -2 + 0i]", "res = [1 + 0i, 1 + 0i, 1 + 0i]");
+
+    inputs.add("fft2([[1, 2], [3, 4]])", "rfft([1i])");
+    outputs.add("res = [[10 + 0i, -2 + 0i], [-4 + 0i, 0 + 0i]]",
+        "[Line 1] semantic error: invalid argument for function rfft: "
+        "expected an array of real numbers");
+
+    inputs.add("array a = [1]", "pop(a)", "rfft(a)", "fft(a)");
+    outputs.add("res = 1", "res = []", "res = []");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v23) {
+    Container inputs;
+    Container outputs;
+    inputs.add("conv([1, 2, 3], [1, 1])", "conv([1, 2, 3, 4, 5], [1, 2, 1], 1)",
+        "conv([1, 2, 3, 4, 5], [1, 2, 1], 2)",
+        "stencil([1, 2, 3, 4], [1, 0, -1])");
+    outputs.add("res = [1, 3, 5, 3]", "res = [4, 8, 12, 16, 14]",
+        "res = [8, 12, 16]", "res = [-2, -2, -2, 3]");
+
+    inputs.add("conv2([[1, 2], [3, 4]], [[1, 1], [1, 1]])",
+        "conv([1, 2], [1], 5)");
+    outputs.add("res = [[1, 3, 2], [4, 10, 6], [3, 7, 4]]",
+        "[Line 1] semantic error: invalid argument for function conv: "
+        "mode must be 0 (full), 1 (same) or 2 (valid)");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v24) {
+    Container inputs;
+    Container outputs;
+    inputs.add("function sq(var x): return x * x.", "quad(sq, 0, 3)",
+        "quad(3, 0, 1)");
+    outputs.add("res = 9", "[Line 2] semantic error: invalid argument "
+        "for function quad: expected a function");
+
+    inputs.add("function decay(var t, var y): return -y.",
+        "auto r = ode_rk45(decay, 1, 0, 1)", "pop(r)",
+        "ode_rk45(decay, 2, 1, 1)");
+    outputs.add("res = [1, 0.36788]", "res = [[1, 2]]");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v25) {
+    Container inputs;
+    Container outputs;
+    inputs.add("function sq(var x): return x * x.",
+        "function add(var a, var b): return a + b.",
+        "function big(var x): return x > 2.", "map(sq, [1, 2, 3])",
+        "reduce(add, [1, 2, 3, 4], 0)", "filter(big, [1, 5, 2, 7])");
+    outputs.add("res = [1, 4, 9]", "res = 10", "res = [5, 7]");
+
+    inputs.add("function total(array r): return r[0] + r[1].",
+        "map_rows(total, [[1, 2], [3, 4]])", "map(total, [1])");
+    outputs.add("res = [3, 7]", "[Line 2] semantic error: mismatching type "
+        "for parameter r in function total (expected array, got scalar)");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v26) {
+    Container inputs;
+    Container outputs;
+    inputs.add("matrix [2, 3] m: int", "auto w = whos()", "w[0, 0]",
+        "w[0, 1]", "w[0, 2]", "w[0, 3]", "w[1, 0]");
+    outputs.add("res = 2", "res = 3", "res = 2", "res = 3", "res = 0");
+
+    inputs.add("var whosn = 0", "if (true):whosn += 1.", "whosn");
+    outputs.add("res = 1");
+
+    run_tests(inputs, outputs);
+}
+
+TEST_F(FalkTest, interpreter_v27) {
+    Container inputs;
+    inputs.add("array a = [1, 2, 3]", "var s = 0", "for (x in a): s += x.",
+        "s", "function f(var n): return n + 1.", "f(2)");
+
+    expect_report(run_with(inputs, "--stats"), {"res = 6\nres = 3\n",
+        "for_it                                             1",
+        "declare_variable                                   2",
+        "scopes:         1 opened, 1 closed", "deep copies:",
+        "symbol lookups:", "allocated:"});
+}
+
+TEST_F(FalkTest, interpreter_v28) {
+    Container inputs;
+    inputs.add("function spin(var n):", "var i = 0",
+        "while (i < n): i += 1.", "return i", ".", "spin(1000000)", "x");
+
+    expect_report(run_with(inputs, "--profile"), {"res = 1000000\n",
+        "[Line 6] semantic error: undeclared variable x", "hot lines",
+        "%  3\n", "%  spin\n", "call tree", "%  <script>\n",
+        "%    spin\n"});
+}
+
+TEST_F(FalkTest, interpreter_v29) {
+    Container inputs;
+    inputs.add("function f(array a): return a.", "array x = [1, 2]", "f(x)",
+        "matrix [64, 64] m : real", "auto p = m * m",
+        "array r = sort(rand(5000))");
+
+    expect_report(run_with(inputs, "--trace", "trace.json"),
+        {"res = [1, 2]\n"});
+    expect_report(read_file("trace.json"), {"{\"traceEvents\": [\n",
+        "\"name\": \"thread_name\", \"args\": {\"name\": \"interpreter\"}",
+        "\"name\": \"command\", \"args\": {\"line\": \"3\"}",
+        "\"name\": \"f\"}", "\"args\": {\"a\": \"array[2]\"}",
+        "\"name\": \"gemm\", \"args\": {\"lhs\": \"matrix[64, 64]\", "
+        "\"rhs\": \"matrix[64, 64]\"}",
+        "\"name\": \"rand\", \"args\": {\"shape\": \"array[5000]\"}",
+        "\"name\": \"sort\", \"args\": {\"x\": \"array[5000]\"}",
+        "], \"displayTimeUnit\": \"ms\"}"});
+    std::remove("trace.json");
+}
+
+TEST_F(FalkTest, interpreter_v30) {
+    Container inputs;
+    inputs.add("array a = [1, 2]", "1 + a", "auto b = a", "[[1, 2]] + a");
+
+    expect_report(run_with(inputs, "--audit"), {"res = [2, 3]\n",
+        "res = [[2, 4]]\n",
+        "broadcast (scalar::to_array)                 1",
+        "promotion (array::to_matrix)                 1", "top offenders",
+        "2       broadcast (scalar::to_array)",
+        "3       value copy (valueof)",
+        "4       promotion (array::to_matrix)"});
+}
+
 int main(int argc, char** argv) {
     constexpr double min_version = 0;
-    constexpr double latest_stable = 1;
+    constexpr double latest_stable = 3;
 
     ::testing::InitGoogleTest(&argc, argv);
     const std::string tests = [&] {